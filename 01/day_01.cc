@@ -4,11 +4,14 @@
 //
 
 #include <algorithm>
+#include <cstdint>
 #include <numeric>
 #include <ranges>
-#include <unordered_map>
+#include <span>
+#include <vector>
 
 #include "testrunner/testrunner.h"
+#include "utils/radix_sort.hh"
 #include "utils/read_file.hh"
 #include "utils/split.hh"
 
@@ -29,8 +32,8 @@ namespace Day1 {
   }
 
   // Part 1 requires sorting; Part 2 doesn't care...
-  std::sort(left.begin(), left.end());
-  std::sort(right.begin(), right.end());
+  Utils::radixSort(std::span{left});
+  Utils::radixSort(std::span{right});
 
   return {left, right};
 }
@@ -43,21 +46,44 @@ namespace Day1 {
   return std::accumulate(std::begin(range), std::end(range), int{});
 }
 
+// Both lists are sorted, so equal numbers form a run in each; walking both
+// lists in step pairs up the runs without a histogram.
 [[nodiscard]] auto similarityScore(const std::vector<int>& first,
-                                   const std::vector<int>& second) -> int {
-  auto map = std::unordered_map<int, int>{};
-  for (const auto& right : second) ++map[right];
+                                   const std::vector<int>& second)
+    -> int64_t {
+  auto score = int64_t{};
+  auto left  = first.begin();
+  auto right = second.begin();
 
-  auto weighted = [&map](auto lookup) {
-    return lookup * (map.contains(lookup) ? map[lookup] : int{});
-  };
+  while (left != first.end() and right != second.end()) {
+    if (*left < *right) {
+      ++left;
+    } else if (*right < *left) {
+      ++right;
+    } else {
+      const auto left_end  = std::upper_bound(left, first.end(), *left);
+      const auto right_end = std::upper_bound(right, second.end(), *right);
+      score += static_cast<int64_t>(*left) * (left_end - left) *
+               (right_end - right);
+      left  = left_end;
+      right = right_end;
+    }
+  }
 
-  const auto range = first | std::views::transform(weighted);
-  return std::accumulate(std::begin(range), std::end(range), int{});
+  return score;
 }
 
 }  // namespace Day1
 
+TEST(Day_01_Radix_Sort) {
+  auto values = std::vector<int>{3, -1, 0, 70000, -70000, 3, 2147483647,
+                                 -2147483647 - 1, 256, 255, 65536, -256};
+  auto sorted = values;
+  std::ranges::sort(sorted);
+  Utils::radixSort(std::span{values});
+  EXPECT_EQ(values, sorted);
+}
+
 TEST(Day_01_Historian_Hysteria_SAMPLE) {
   auto [first, second] = Day1::readListsSorted("01/sample.txt");
   EXPECT_EQ(Day1::totalDistance(first, second), 11);
@@ -4,27 +4,31 @@
 //
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <functional>
+#include <optional>
 #include <ranges>
+#include <span>
 
 #include "testrunner/testrunner.h"
+#include "utils/jagged_array.hh"
 #include "utils/read_file.hh"
 #include "utils/split.hh"
 
 namespace Day2 {
 
-[[nodiscard]] auto readReports(const std::filesystem::path& path) {
-  return Utils::readLines(path)  //
-         | std::views::transform([](const auto& line) {
-             return Utils::split<int>(line, " ");
-           })  //
-         | std::ranges::to<std::vector>();
+using Report = std::span<const int>;
+
+using Reports = Utils::JaggedArray<int>;
+
+[[nodiscard]] auto readReports(const std::filesystem::path& path) -> Reports {
+  return Utils::splitLines<int>(Utils::readLines(path), " ");
 }
 
-[[nodiscard]] constexpr auto minmaxDifference(const std::vector<int>& record)
+[[nodiscard]] constexpr auto minmaxDifference(Report report)
     -> std::ranges::minmax_result<int> {
-  return std::ranges::minmax(record |
+  return std::ranges::minmax(report |
                              std::views::pairwise_transform(std::minus<int>{}));
 }
 
@@ -36,27 +40,46 @@ namespace Day2 {
          and std::signbit(minmax.min) == std::signbit(minmax.max);
 }
 
-[[nodiscard]] auto safeReports(const auto& records) {
-  const auto validated = records                                    //
+[[nodiscard]] auto safeReports(const Reports& reports) {
+  const auto validated = reports                                    //
                          | std::views::transform(minmaxDifference)  //
                          | std::views::transform(isSafe);
   return std::ranges::count(validated, true);
 }
 
-[[nodiscard]] auto safeReportsWithTolerance(const auto& records) {
-  constexpr auto validate = [](auto record) -> bool {
-    for (int64_t skip_idx = 0; skip_idx != static_cast<int64_t>(record.size());
-         ++skip_idx) {
-      auto copy = record;
-      copy.erase(copy.begin() + skip_idx);
-      const auto valid = isSafe(minmaxDifference(copy));
-      if (valid) return true;
-    }
-    return false;
-  };
-
-  const auto validated = records | std::views::transform(validate);
-  return std::ranges::count(validated, true);
+// A step between levels that keeps a report going in direction `sign`
+[[nodiscard]] constexpr auto isSafeStep(int from, int to, int sign) -> bool {
+  const auto step = (to - from) * sign;
+  return step >= 1 and step <= 3;
+}
+
+// Index of the first level that doesn't step safely from the one before it,
+// leaving out level `skip`; report.size() if there is none
+[[nodiscard]] constexpr auto firstUnsafeStep(Report report, int sign,
+                                             size_t skip) -> size_t {
+  auto previous = std::optional<int>{};
+  for (size_t idx = 0; idx != report.size(); ++idx) {
+    if (idx == skip) continue;
+    if (previous and !isSafeStep(*previous, report[idx], sign)) return idx;
+    previous = report[idx];
+  }
+  return report.size();
+}
+
+// Whichever level is removed, the first unsafe step has to lose one of its
+// two ends, so only those two removals need checking
+[[nodiscard]] constexpr auto isSafeWithTolerance(Report report) -> bool {
+  const auto none = report.size();
+  return std::ranges::any_of(std::array{1, -1}, [&](int sign) {
+    const auto unsafe = firstUnsafeStep(report, sign, none);
+    return unsafe == none or
+           firstUnsafeStep(report, sign, unsafe - 1) == none or
+           firstUnsafeStep(report, sign, unsafe) == none;
+  });
+}
+
+[[nodiscard]] auto safeReportsWithTolerance(const Reports& reports) {
+  return std::ranges::count_if(reports, isSafeWithTolerance);
 }
 
 }  // namespace Day2
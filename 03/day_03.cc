@@ -4,100 +4,285 @@
 //
 
 #include <algorithm>
-#include <cctype>
-#include <optional>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <string_view>
+#include <tuple>
 #include <vector>
 
 #include "testrunner/testrunner.h"
+#include "utils/parallel.hh"
 #include "utils/read_file.hh"
 
 namespace Day3 {
 
-using namespace std::literals;
-constexpr auto MUL_OP         = "mul("sv;
-constexpr auto DO_DIRECTIVE   = "do()"sv;
-constexpr auto DONT_DIRECTIVE = "don't()"sv;
+// Offset of the first 'm' or 'd' in `chars` from `from` on, the only
+// characters a token can start with. Checks 32 bytes per round, eight to a
+// word: XOR-ing with the wanted byte turns matches into zero bytes, and the
+// lowest flagged zero byte is always a real one. Words are read little endian
+// whatever the platform, so the lowest byte is always the first character.
+[[nodiscard]] inline auto nextCandidate(std::string_view chars, size_t from)
+    -> size_t {
+  static constexpr auto ones  = 0x0101'0101'0101'0101ULL;
+  static constexpr auto highs = 0x8080'8080'8080'8080ULL;
 
-struct Op {
-  std::vector<int> operands{};
-  std::string_view* chars;
-};
+  const auto zero_bytes = [](uint64_t word) {
+    return (word - ones) & ~word & highs;
+  };
+  const auto candidates = [&](uint64_t word) {
+    return zero_bytes(word ^ (ones * 'm')) | zero_bytes(word ^ (ones * 'd'));
+  };
 
-[[nodiscard]] constexpr auto find(std::string_view what,
-                                  Op op) -> std::optional<Op> {
-  const auto found_at = op.chars->find(what);
-  op.chars->remove_prefix(
-      std::min(found_at + what.length(), op.chars->length()));
-  if (found_at == std::string_view::npos) return std::nullopt;
-  return op;
-}
+  static constexpr auto words = size_t{4};
+  for (; from + words * 8 <= chars.size(); from += words * 8) {
+    auto block = std::array<uint64_t, words>{};
+    std::memcpy(block.data(), chars.data() + from, words * 8);
+    if constexpr (std::endian::native == std::endian::big)
+      for (auto& word : block) word = std::byteswap(word);
 
-[[nodiscard]] constexpr auto extractNumber(Op op) -> std::optional<Op> {
-  if (op.chars->empty() or (std::isdigit(op.chars->at(0)) == 0))
-    return std::nullopt;
-  auto number = int{};
-  for (size_t digits = 0; digits != 3; ++digits) {
-    if (std::isdigit(op.chars->at(0)) == 0) break;
-    number *= 10;  // NOLINT; 10 is not magic here ;)
-    number += op.chars->at(0) - '0';
-    op.chars->remove_prefix(1);
+    for (size_t word = 0; word != words; ++word) {
+      if (const auto found = candidates(block[word]); found != 0) {
+        return from + word * 8 +
+               static_cast<size_t>(std::countr_zero(found) / 8);
+      }
+    }
   }
-  op.operands.push_back(number);
-  return op;
+
+  for (; from != chars.size(); ++from)
+    if (chars[from] == 'm' or chars[from] == 'd') return from;
+  return from;
 }
 
-template <char WHAT>
-[[nodiscard]] constexpr auto expect(Op op) -> std::optional<Op> {
-  if (op.chars->empty() or op.chars->at(0) != WHAT) return std::nullopt;
-  op.chars->remove_prefix(1);
-  return op;
+// Matches mul(a,b), do() and don't() one character at a time. A character
+// that doesn't continue the token in progress starts matching over from that
+// character, so the state is all there is to carry from one chunk of input
+// to the next.
+class Scanner {
+  enum class State : uint8_t {
+    Start,
+    M,
+    Mu,
+    Mul,
+    Lhs,
+    Rhs,
+    D,
+    Do,
+    DoOpen,
+    Don,
+    DonApostrophe,
+    Dont,
+    DontOpen
+  };
+
+  static constexpr auto max_digits = 3;
+
+  State state_{State::Start};
+  int64_t lhs_{};
+  int64_t rhs_{};
+  int digits_{};
+
+  // False if `chr` doesn't continue the token in progress
+  constexpr auto advance(char chr, auto& on_mul, auto& on_directive) -> bool {
+    const auto to = [&](State state, char expected) {
+      if (chr != expected) return false;
+      state_ = state;
+      return true;
+    };
+
+    const auto digit = [&](int64_t& operand) {
+      if (chr < '0' or chr > '9' or digits_ == max_digits) return false;
+      operand = operand * 10 + (chr - '0');
+      ++digits_;
+      return true;
+    };
+
+    switch (state_) {
+      case State::Start:
+        return to(State::M, 'm') or to(State::D, 'd');
+      case State::M:
+        return to(State::Mu, 'u');
+      case State::Mu:
+        return to(State::Mul, 'l');
+      case State::Mul:
+        lhs_    = 0;
+        rhs_    = 0;
+        digits_ = 0;
+        return to(State::Lhs, '(');
+      case State::Lhs:
+        if (digit(lhs_)) return true;
+        if (digits_ == 0 or !to(State::Rhs, ',')) return false;
+        digits_ = 0;
+        return true;
+      case State::Rhs:
+        if (digit(rhs_)) return true;
+        if (digits_ == 0 or !to(State::Start, ')')) return false;
+        on_mul(lhs_ * rhs_);
+        return true;
+      case State::D:
+        return to(State::Do, 'o');
+      case State::Do:
+        return to(State::DoOpen, '(') or to(State::Don, 'n');
+      case State::DoOpen:
+        if (!to(State::Start, ')')) return false;
+        on_directive(true);
+        return true;
+      case State::Don:
+        return to(State::DonApostrophe, '\'');
+      case State::DonApostrophe:
+        return to(State::Dont, 't');
+      case State::Dont:
+        return to(State::DontOpen, '(');
+      case State::DontOpen:
+        if (!to(State::Start, ')')) return false;
+        on_directive(false);
+        return true;
+    }
+    return false;
+  }
+
+ public:
+  // Calls on_mul(product) for every mul(a,b) and on_directive(enabled) for
+  // every do() and don't() completed in `chunk`
+  void scan(std::string_view chunk, auto&& on_mul, auto&& on_directive) {
+    for (size_t idx = 0; idx != chunk.size(); ++idx) {
+      if (idle()) {
+        idx = nextCandidate(chunk, idx);
+        if (idx == chunk.size()) break;
+      }
+
+      const auto was_idle = idle();
+      if (advance(chunk[idx], on_mul, on_directive) or was_idle) continue;
+      state_      = State::Start;
+      std::ignore = advance(chunk[idx], on_mul, on_directive);
+    }
+  }
+
+  // Completes the token in progress, if `rest` continues it, but doesn't
+  // start any new ones
+  void finish(std::string_view rest, auto&& on_mul, auto&& on_directive) {
+    for (const auto chr : rest) {
+      if (idle()) return;
+      if (!advance(chr, on_mul, on_directive)) state_ = State::Start;
+    }
+    state_ = State::Start;
+  }
+
+  [[nodiscard]] constexpr auto idle() const -> bool {
+    return state_ == State::Start;
+  }
+};
+
+struct Totals {
+  int64_t all{};
+  int64_t enabled{};  // Only while the last directive was a do()
+};
+
+// Both answers in a single pass over input that arrives in chunks of any size
+class Parser {
+  Scanner scanner_{};
+  Totals totals_{};
+  bool enabled_{true};
+
+ public:
+  void feed(std::string_view chunk) {
+    scanner_.scan(
+        chunk,
+        [&](int64_t product) {
+          totals_.all += product;
+          if (enabled_) totals_.enabled += product;
+        },
+        [&](bool enabled) { enabled_ = enabled; });
+  }
+
+  [[nodiscard]] constexpr auto totals() const -> Totals { return totals_; }
+};
+
+[[nodiscard]] auto parse(std::string_view chars, size_t chunk_size = 1 << 16)
+    -> Totals {
+  auto parser = Parser{};
+  while (!chars.empty()) {
+    parser.feed(chars.substr(0, chunk_size));
+    chars.remove_prefix(std::min(chunk_size, chars.size()));
+  }
+  return parser.totals();
 }
 
-[[nodiscard]] constexpr auto multiply(Op op) -> std::optional<int> {
-  if (op.operands.size() != 2) return std::nullopt;
-  return op.operands.at(0) * op.operands.at(1);
+// Reads `input` a chunk at a time, so it never has to fit in memory
+[[nodiscard]] auto parse(std::istream& input, size_t chunk_size = 1 << 16)
+    -> Totals {
+  auto parser = Parser{};
+  auto buffer = std::vector<char>(chunk_size);
+  while (input.read(buffer.data(), static_cast<std::streamsize>(chunk_size)) or
+         input.gcount() != 0) {
+    parser.feed({buffer.data(), static_cast<size_t>(input.gcount())});
+  }
+  return parser.totals();
 }
 
-[[nodiscard]] constexpr auto nextOp(std::string_view* chars)
-    -> std::optional<int> {
-  return find(MUL_OP, {.chars = chars})
-      .and_then(extractNumber)
-      .and_then(expect<','>)
-      .and_then(extractNumber)
-      .and_then(expect<')'>)
-      .and_then(multiply);
+[[nodiscard]] auto parseGibberish(std::string_view chars) -> int64_t {
+  return parse(chars).all;
 }
 
-[[nodiscard]] constexpr auto parseGibberish(std::string_view chars) -> int {
-  auto total = int{};
-  while (!chars.empty()) {
-    if (const auto op = Day3::nextOp(&chars)) total += *op;
-  }
-  return total;
+[[nodiscard]] auto parseGibberishConditionally(std::string_view chars)
+    -> int64_t {
+  return parse(chars).enabled;
 }
 
-[[nodiscard]] constexpr auto removeDisabledParts(std::string_view chars)
-    -> std::string {
-  auto str = std::string{chars};
+// What a slice of the input adds up to, for either state the slice may be
+// entered in, since that depends on the directives before it
+struct SliceTotals {
+  int64_t all{};
+  std::array<int64_t, 2> enabled{};                 // Per incoming state
+  std::array<bool, 2> enabled_after{false, true};  // Per incoming state
+};
 
-  auto dont_pos = str.find(DONT_DIRECTIVE);
-  while (dont_pos != std::string::npos) {
-    auto until = str.find(DO_DIRECTIVE, dont_pos);
-    if (until != std::string::npos) until -= (dont_pos - DO_DIRECTIVE.length());
-    str.erase(dont_pos, until);
-    dont_pos = str.find(DONT_DIRECTIVE);
-  }
+[[nodiscard]] auto scanSlice(std::string_view chars, size_t begin, size_t end)
+    -> SliceTotals {
+  auto totals       = SliceTotals{};
+  const auto on_mul = [&](int64_t product) {
+    totals.all += product;
+    for (size_t incoming = 0; incoming != 2; ++incoming)
+      if (totals.enabled_after[incoming]) totals.enabled[incoming] += product;
+  };
+  const auto on_directive = [&](bool enabled) {
+    totals.enabled_after = {enabled, enabled};
+  };
 
-  return str;
+  // A token that starts in this slice is counted here, wherever it ends
+  auto scanner = Scanner{};
+  scanner.scan(chars.substr(begin, end - begin), on_mul, on_directive);
+  scanner.finish(chars.substr(end), on_mul, on_directive);
+  return totals;
 }
 
-[[nodiscard]] constexpr auto parseGibberishConditionally(
-    std::string_view from_file) -> int {
-  // We could have used regular expressions to parse the string....
-  // We could have tokenized it and then parsed it properly....
-  // But no...
-  // We're just brute force removing the "don't()" parts ;)
-  return parseGibberish(removeDisabledParts(std::string_view{from_file}));
+// Slices are scanned independently on worker threads, then folded in order,
+// threading the enabled state from one slice into the next.
+[[nodiscard]] auto parseInParallel(std::string_view chars,
+                                   size_t workers    = Utils::hardwareThreads(),
+                                   size_t slice_size = 1 << 20) -> Totals {
+  auto slices = std::vector<SliceTotals>((chars.size() + slice_size - 1) /
+                                         slice_size);
+  Utils::parallelFor(
+      slices.size(),
+      [&](size_t slice) {
+        const auto begin = slice * slice_size;
+        slices[slice] =
+            scanSlice(chars, begin, std::min(chars.size(), begin + slice_size));
+      },
+      workers);
+
+  auto totals  = Totals{};
+  auto enabled = size_t{1};
+  for (const auto& slice : slices) {
+    totals.all += slice.all;
+    totals.enabled += slice.enabled[enabled];
+    enabled = slice.enabled_after[enabled] ? 1 : 0;
+  }
+  return totals;
 }
 
 }  // namespace Day3
@@ -106,6 +291,17 @@ TEST(Day_03_Mull_It_Over_SAMPLE) {
   const auto file = Utils::readFile("03/sample.txt");
   EXPECT_EQ(Day3::parseGibberish(std::string_view{file}), 161);
   EXPECT_EQ(Day3::parseGibberishConditionally(std::string_view{file}), 48);
+
+  for (const auto chunk_size : {1U, 2U, 5U}) {
+    const auto totals = Day3::parse(std::string_view{file}, chunk_size);
+    EXPECT_EQ(totals.all, 161);
+    EXPECT_EQ(totals.enabled, 48);
+
+    const auto parallel =
+        Day3::parseInParallel(std::string_view{file}, 4, chunk_size);
+    EXPECT_EQ(parallel.all, 161);
+    EXPECT_EQ(parallel.enabled, 48);
+  }
 }
 
 TEST(Day_03_Mull_It_Over_FINAL) {
@@ -113,4 +309,16 @@ TEST(Day_03_Mull_It_Over_FINAL) {
   EXPECT_EQ(Day3::parseGibberish(std::string_view{file}), 166905464);
   EXPECT_EQ(Day3::parseGibberishConditionally(std::string_view{file}),
             72948684);
+
+  auto stream       = std::ifstream("03/input.txt");
+  const auto totals = Day3::parse(stream, 7);
+  EXPECT_EQ(totals.all, 166905464);
+  EXPECT_EQ(totals.enabled, 72948684);
+
+  for (const auto slice_size : {13U, 4096U}) {
+    const auto parallel =
+        Day3::parseInParallel(std::string_view{file}, 4, slice_size);
+    EXPECT_EQ(parallel.all, 166905464);
+    EXPECT_EQ(parallel.enabled, 72948684);
+  }
 }
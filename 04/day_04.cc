@@ -3,13 +3,17 @@
 // https://adventofcode.com/2024/day/4
 //
 
+#include <array>
 #include <filesystem>
 #include <fstream>
-#include <ranges>
+#include <span>
+#include <string_view>
+#include <vector>
 
+#include "letter_masks.hh"
 #include "testrunner/testrunner.h"
+#include "utils/aho_corasick.hh"
 #include "utils/coordinate_directions.hh"
-#include "utils/curry.hh"
 #include "utils/grid.hh"
 
 namespace Day4 {
@@ -21,47 +25,52 @@ using XmasGrid = Utils::Grid<char, Utils::OutOfBoundsPolicy::Default<char{}>>;
   return XmasGrid::from(file);
 }
 
-[[nodiscard]] constexpr auto find(const XmasGrid& grid,
-                                  std::string_view word) -> int64_t {
-  const auto find_rest = [&](this auto self, auto from, auto direction,
-                             auto rest) -> bool {
-    if (rest.empty()) return true;
-    if (grid[from + direction] != rest.front()) return false;
-    return self(from + direction, direction, rest.substr(1));
-  };
-
-  const auto find_first = [&](auto from, auto direction) -> bool {
-    return find_rest(from, direction, std::string_view{"MAS"});
-  };
-
-  const auto is_first = [&](auto coordinate) {
-    return grid[coordinate] == word.front();
-  };
-
-  auto found = std::views::cartesian_product(
-                   grid.coordinates() | std::views::filter(is_first),
-                   Utils::Directions::clockwise())  //
-               | std::views::filter(Utils::uncurry(find_first));
-  return std::distance(std::begin(found), std::end(found));
+// `word` spelled out in every direction
+[[nodiscard]] auto find(const XmasGrid& grid, std::string_view word)
+    -> int64_t {
+  const auto masks = LetterMasks{grid, word};
+  auto pattern     = std::vector<PatternCell>(word.size());
+
+  auto found = int64_t{};
+  for (const auto direction : Utils::Directions::clockwise()) {
+    for (size_t idx = 0; idx != word.size(); ++idx) {
+      pattern[idx] = {.offset = direction * static_cast<int>(idx),
+                      .letter = word[idx]};
+    }
+    found += masks.count(pattern);
+  }
+  return found;
 }
 
-[[nodiscard]] auto x_mas(const XmasGrid& grid) -> int64_t {
-  const auto is_A = [&](auto coordinate) { return grid[coordinate] == 'A'; };
-
-  const auto is_MS = [&](auto from, auto direction) {
-    return (grid[from + direction] == 'M' and grid[from - direction] == 'S') or
-           (grid[from + direction] == 'S' and grid[from - direction] == 'M');
-  };
-
-  const auto is_MAS = [&](auto from) {
-    return is_MS(from, Utils::Direction::upLeft()) and
-           is_MS(from, Utils::Direction::upRight());
-  };
+// `word`, which has to be of odd length, spelled out along both diagonals
+// crossing at its middle letter, each either way round
+[[nodiscard]] auto x_mas(const XmasGrid& grid, std::string_view word = "MAS")
+    -> int64_t {
+  const auto masks = LetterMasks{grid, word};
+  const auto half  = static_cast<int>(word.size() / 2);
+  auto pattern     = std::vector<PatternCell>(word.size() * 2);
+
+  auto found = int64_t{};
+  for (const auto falling :
+       {Utils::Direction::downRight(), Utils::Direction::upLeft()}) {
+    for (const auto rising :
+         {Utils::Direction::upRight(), Utils::Direction::downLeft()}) {
+      for (size_t idx = 0; idx != word.size(); ++idx) {
+        const auto step = static_cast<int>(idx) - half;
+        pattern[idx * 2]     = {.offset = falling * step, .letter = word[idx]};
+        pattern[idx * 2 + 1] = {.offset = rising * step, .letter = word[idx]};
+      }
+      found += masks.count(pattern);
+    }
+  }
+  return found;
+}
 
-  auto found = grid.coordinates()          //
-               | std::views::filter(is_A)  //
-               | std::views::filter(is_MAS);
-  return std::distance(std::begin(found), std::end(found));
+// Every word of `words` in every direction, in a single pass over the grid
+[[nodiscard]] auto findAll(const XmasGrid& grid,
+                           std::span<const std::string_view> words)
+    -> std::vector<size_t> {
+  return Utils::scanGrid(Utils::AhoCorasick{words}, grid);
 }
 
 }  // namespace Day4
@@ -70,10 +79,18 @@ TEST(Day_04_Ceres_Search_SAMPLE) {
   const auto grid = Day4::makeGrid("04/sample.txt");
   EXPECT_EQ(Day4::find(grid, "XMAS"), 18);
   EXPECT_EQ(Day4::x_mas(grid), 9);
+
+  const auto words = std::array<std::string_view, 5>{"XMAS", "SAMX", "MAS",
+                                                     "XM", "A"};
+  const auto found = Day4::findAll(grid, words);
+  for (size_t idx = 0; idx != words.size(); ++idx)
+    EXPECT_EQ(found[idx], Day4::find(grid, words[idx]));
 }
 
 TEST(Day_04_Ceres_Search_FINAL) {
   const auto grid = Day4::makeGrid("04/input.txt");
   EXPECT_EQ(Day4::find(grid, "XMAS"), 2464);
   EXPECT_EQ(Day4::x_mas(grid), 1982);
+  EXPECT_EQ(Day4::findAll(grid, std::array<std::string_view, 1>{"XMAS"}),
+            std::vector<size_t>{2464});
 }
@@ -0,0 +1,102 @@
+#ifndef DAY_4_LETTER_MASKS_HH
+#define DAY_4_LETTER_MASKS_HH
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "utils/coordinate.hh"
+
+namespace Day4 {
+
+// One letter of a search pattern, relative to the cell a match starts on
+struct PatternCell {
+  Utils::Coordinate offset{};
+  char letter{};
+};
+
+// One bit per cell for each letter of interest, 64 cells to a word, row by
+// row. A pattern is matched against 64 start cells at once: the row every
+// pattern letter lands on is shifted to line up with the start cells, and
+// all of those words are ANDed together.
+class LetterMasks {
+  static constexpr auto bits = int64_t{64};
+
+  size_t width_{};
+  size_t height_{};
+  size_t words_{};
+  std::array<std::vector<uint64_t>, 256> masks_{};  // Empty if not asked for
+
+  [[nodiscard]] static constexpr auto letterIndex(char letter) -> size_t {
+    return static_cast<unsigned char>(letter);
+  }
+
+  [[nodiscard]] auto row(char letter, size_t y) const
+      -> std::span<const uint64_t> {
+    const auto& mask = masks_[letterIndex(letter)];
+    if (mask.empty()) return {};
+    return std::span{mask}.subspan(y * words_, words_);
+  }
+
+  // Bits [first, first + 64) of `row`; anything outside of it reads as zero
+  [[nodiscard]] static constexpr auto wordAt(std::span<const uint64_t> row,
+                                             int64_t first) -> uint64_t {
+    const auto word  = (first >= 0 ? first : first - bits + 1) / bits;
+    const auto shift = first - word * bits;
+    const auto at    = [&](int64_t idx) -> uint64_t {
+      if (idx < 0 or idx >= std::ssize(row)) return 0;
+      return row[static_cast<size_t>(idx)];
+    };
+
+    if (shift == 0) return at(word);
+    return (at(word) >> shift) | (at(word + 1) << (bits - shift));
+  }
+
+ public:
+  LetterMasks(const auto& grid, std::string_view letters)
+      : width_{grid.width()},
+        height_{grid.height()},
+        words_{(grid.width() + 63) / 64} {
+    for (const auto letter : letters)
+      masks_[letterIndex(letter)].assign(words_ * height_, 0);
+
+    for (size_t y = 0; y != height_; ++y) {
+      for (size_t x = 0; x != width_; ++x) {
+        auto& mask = masks_[letterIndex(grid[x, y])];
+        if (!mask.empty()) mask[y * words_ + x / 64] |= 1ULL << (x % 64);
+      }
+    }
+  }
+
+  // Number of cells the pattern matches from
+  [[nodiscard]] auto count(std::span<const PatternCell> pattern) const
+      -> int64_t {
+    const auto tail_bits = width_ % 64;
+    const auto tail_mask = tail_bits == 0 ? ~0ULL : (1ULL << tail_bits) - 1;
+
+    auto found = int64_t{};
+    for (size_t y = 0; y != height_; ++y) {
+      for (size_t word = 0; word != words_; ++word) {
+        auto match = word + 1 == words_ ? tail_mask : ~0ULL;
+        for (const auto& cell : pattern) {
+          const auto at_y = static_cast<int64_t>(y) + cell.offset.y;
+          if (at_y < 0 or at_y >= static_cast<int64_t>(height_)) {
+            match = 0;
+            break;
+          }
+          match &= wordAt(row(cell.letter, static_cast<size_t>(at_y)),
+                          static_cast<int64_t>(word) * bits + cell.offset.x);
+        }
+        found += std::popcount(match);
+      }
+    }
+    return found;
+  }
+};
+
+}  // namespace Day4
+
+#endif  // DAY_4_LETTER_MASKS_HH
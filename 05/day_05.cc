@@ -4,22 +4,48 @@
 //
 
 #include <algorithm>
+#include <array>
+#include <bitset>
+#include <optional>
 #include <ranges>
-#include <unordered_map>
-#include <unordered_set>
+#include <span>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include "testrunner/testrunner.h"
+#include "utils/jagged_array.hh"
 #include "utils/nm_view.hh"
+#include "utils/parallel.hh"
 #include "utils/read_file.hh"
 #include "utils/split.hh"
 #include "utils/sum.hh"
 
 namespace Day5 {
 
-using RuleMap = std::unordered_map<int, std::unordered_set<int>>;
-using Pages   = std::vector<int>;
-using Manuals = std::vector<Pages>;
+// Page numbers are two digits, so every rule fits in a 100 x 100 bit matrix
+struct RuleMap {
+  static constexpr auto max_pages = size_t{100};
+
+  std::array<std::bitset<max_pages>, max_pages> after{};
+
+  void insert(int before, int later) {
+    after[static_cast<size_t>(before)].set(static_cast<size_t>(later));
+  }
+
+  [[nodiscard]] constexpr auto precedes(int before, int later) const -> bool {
+    return after[static_cast<size_t>(before)][static_cast<size_t>(later)];
+  }
+
+  // Everything else indexes past the matrix, so it is rejected on load
+  static void checkPage(int page) {
+    if (page < 0 or static_cast<size_t>(page) >= max_pages)
+      throw std::out_of_range("Page number out of range");
+  }
+};
+
+using Pages   = std::span<const int>;
+using Manuals = Utils::JaggedArray<int>;
 
 [[nodiscard]] auto makeRuleMap(const std::filesystem::path& path) -> RuleMap {
   const auto split_rule = [](const auto& line) constexpr {
@@ -28,36 +54,69 @@ using Manuals = std::vector<Pages>;
   const auto rules = Utils::readLines(path)  //
                      | std::views::transform(split_rule);
   auto rule_map = RuleMap{};
-  for (const auto [before, after] : rules) rule_map[before].insert(after);
+  for (const auto [before, after] : rules) {
+    RuleMap::checkPage(before);
+    RuleMap::checkPage(after);
+    rule_map.insert(before, after);
+  }
   return rule_map;
 }
 
 [[nodiscard]] auto makePages(const std::filesystem::path& path) -> Manuals {
-  const auto split_pages = [](const auto& line) constexpr {
-    return Utils::split<int>(line, ",");
-  };
-  return Utils::readLines(path)                //
-         | std::views::transform(split_pages)  //
-         | std::ranges::to<std::vector>();
+  auto manuals = Utils::splitLines<int>(Utils::readLines(path), ",");
+  for (const auto page : manuals.values()) RuleMap::checkPage(page);
+  return manuals;
 }
 
-[[nodiscard]] constexpr auto midpoint(const Pages& pages) -> int {
-  return pages.at(pages.size() / 2);
+[[nodiscard]] constexpr auto midpoint(Pages pages) -> int {
+  return pages[pages.size() / 2];
 };
 
-[[nodiscard]] auto isValid(const RuleMap& rules, const Pages& pages) -> bool {
-  auto seen = std::unordered_set<int>{};
+[[nodiscard]] auto isValid(const RuleMap& rules, Pages pages) -> bool {
+  auto seen = std::bitset<RuleMap::max_pages>{};
   for (const auto& page : pages) {
-    if (rules.contains(page)) {
-      for (const auto& maybe_invalid : rules.at(page)) {
-        if (seen.contains(maybe_invalid)) return false;
-      }
-    }
-    seen.insert(page);
+    const auto idx = static_cast<size_t>(page);
+    if ((rules.after[idx] & seen).any()) return false;
+    seen.set(idx);
   }
   return true;
 }
 
+// When the rules totally order the pages of a manual, each page must precede
+// exactly as many of the others as it sits from the end, so the middle page
+// is found by counting alone. Anything else (repeated pages, missing or
+// cyclic rules) gives no such ranking.
+[[nodiscard]] auto rankedMidpoint(const RuleMap& rules, Pages pages)
+    -> std::optional<int> {
+  auto present = std::bitset<RuleMap::max_pages>{};
+  for (const auto page : pages) present.set(static_cast<size_t>(page));
+  if (present.count() != pages.size()) return std::nullopt;
+
+  const auto middle_rank = pages.size() - 1 - pages.size() / 2;
+  auto ranks             = std::bitset<RuleMap::max_pages>{};
+  auto middle            = std::optional<int>{};
+  for (const auto page : pages) {
+    const auto rank =
+        (rules.after[static_cast<size_t>(page)] & present).count();
+    if (rank >= pages.size() or ranks.test(rank)) return std::nullopt;
+    ranks.set(rank);
+    if (rank == middle_rank) middle = page;
+  }
+  return middle;
+}
+
+// Rules that aren't a total order on the manual fall back to one pass of
+// pairwise swaps, which is well defined for any rules
+[[nodiscard]] auto reorderedMidpoint(const RuleMap& rules, Pages pages) -> int {
+  if (const auto middle = rankedMidpoint(rules, pages)) return *middle;
+
+  auto copy = std::vector<int>(pages.begin(), pages.end());
+  for (auto [before, after] : Utils::nm_view(copy)) {
+    if (rules.precedes(*after, *before)) std::swap(*before, *after);
+  }
+  return midpoint(copy);
+}
+
 [[nodiscard]] auto validMiddlePageSum(const RuleMap& rules,
                                       const Manuals& manuals) -> int {
   const auto is_valid = [&](const auto& pages) constexpr {
@@ -75,18 +134,58 @@ using Manuals = std::vector<Pages>;
     return !isValid(rules, pages);
   };
 
-  const auto reorder = [&](auto pages) {
-    for (auto [before, after] : Utils::nm_view(pages)) {
-      if (rules.contains(*after) and rules.at(*after).contains(*before))
-        std::swap(*before, *after);
-    }
-    return pages;
+  const auto reorder = [&](const auto& pages) {
+    return reorderedMidpoint(rules, pages);
   };
 
   return Utils::sum(manuals                           //
                     | std::views::filter(is_invalid)  //
-                    | std::views::transform(reorder)  //
-                    | std::views::transform(midpoint));
+                    | std::views::transform(reorder));
+}
+
+// Both answers from one pass over the manuals. The manuals are split into
+// chunks that are classified in parallel against the same read-only rules;
+// chunk results are merged in order, so the index lists stay sorted.
+struct Batch {
+  std::vector<size_t> valid;
+  std::vector<size_t> invalid;
+  int valid_middle_sum{};
+  int reordered_middle_sum{};
+};
+
+[[nodiscard]] auto classify(const RuleMap& rules, const Manuals& manuals,
+                            size_t workers    = Utils::hardwareThreads(),
+                            size_t chunk_size = 1024) -> Batch {
+  auto chunks = std::vector<Batch>((manuals.size() + chunk_size - 1) /
+                                   chunk_size);
+  Utils::parallelFor(
+      chunks.size(),
+      [&](size_t chunk) {
+        auto& batch     = chunks[chunk];
+        const auto last = std::min(manuals.size(), (chunk + 1) * chunk_size);
+        for (auto idx = chunk * chunk_size; idx != last; ++idx) {
+          if (isValid(rules, manuals[idx])) {
+            batch.valid.push_back(idx);
+            batch.valid_middle_sum += midpoint(manuals[idx]);
+          } else {
+            batch.invalid.push_back(idx);
+            batch.reordered_middle_sum +=
+                reorderedMidpoint(rules, manuals[idx]);
+          }
+        }
+      },
+      workers);
+
+  auto batch = Batch{};
+  for (const auto& chunk : chunks) {
+    batch.valid.insert(batch.valid.end(), chunk.valid.begin(),
+                       chunk.valid.end());
+    batch.invalid.insert(batch.invalid.end(), chunk.invalid.begin(),
+                         chunk.invalid.end());
+    batch.valid_middle_sum += chunk.valid_middle_sum;
+    batch.reordered_middle_sum += chunk.reordered_middle_sum;
+  }
+  return batch;
 }
 
 }  // namespace Day5
@@ -96,6 +195,44 @@ TEST(Day_05_Print_Queue_SAMPLE) {
   const auto manuals = Day5::makePages("05/sample_pages.txt");
   EXPECT_EQ(Day5::validMiddlePageSum(rules, manuals), 143);
   EXPECT_EQ(Day5::reorderInvalidPages(rules, manuals), 123);
+
+  auto valid   = std::vector<size_t>{};
+  auto invalid = std::vector<size_t>{};
+  for (size_t idx = 0; idx != manuals.size(); ++idx)
+    (Day5::isValid(rules, manuals[idx]) ? valid : invalid).push_back(idx);
+
+  for (const auto chunk_size : {size_t{1}, size_t{7}, size_t{1024}}) {
+    const auto batch = Day5::classify(rules, manuals, 4, chunk_size);
+    EXPECT_EQ(batch.valid_middle_sum, 143);
+    EXPECT_EQ(batch.reordered_middle_sum, 123);
+    EXPECT_EQ(std::ranges::is_sorted(batch.valid), true);
+    EXPECT_EQ(std::ranges::is_sorted(batch.invalid), true);
+    EXPECT_EQ(batch.valid == valid, true);
+    EXPECT_EQ(batch.invalid == invalid, true);
+  }
+}
+
+TEST(Day_05_Print_Queue_Ordering) {
+  auto rules = Day5::RuleMap{};
+  rules.insert(1, 2);
+  rules.insert(2, 3);
+  const auto total = std::array{3, 1, 2};
+  EXPECT_EQ(Day5::rankedMidpoint(rules, total).has_value(), false);
+  rules.insert(1, 3);
+  EXPECT_EQ(Day5::rankedMidpoint(rules, total).value(), 2);
+  EXPECT_EQ(Day5::reorderedMidpoint(rules, total), 2);
+
+  const auto repeated = std::array{1, 2, 1};
+  EXPECT_EQ(Day5::rankedMidpoint(rules, repeated).has_value(), false);
+
+  // A cycle has no ranking, so the swap pass decides
+  auto cycle = Day5::RuleMap{};
+  cycle.insert(1, 2);
+  cycle.insert(2, 3);
+  cycle.insert(3, 1);
+  const auto cyclic = std::array{3, 2, 1};
+  EXPECT_EQ(Day5::rankedMidpoint(cycle, cyclic).has_value(), false);
+  EXPECT_EQ(Day5::reorderedMidpoint(cycle, cyclic), 2);
 }
 
 TEST(Day_05_Print_Queue_FINAL) {
@@ -103,4 +240,19 @@ TEST(Day_05_Print_Queue_FINAL) {
   const auto manuals = Day5::makePages("05/input_pages.txt");
   EXPECT_EQ(Day5::validMiddlePageSum(rules, manuals), 5374);
   EXPECT_EQ(Day5::reorderInvalidPages(rules, manuals), 4260);
+
+  auto valid   = std::vector<size_t>{};
+  auto invalid = std::vector<size_t>{};
+  for (size_t idx = 0; idx != manuals.size(); ++idx)
+    (Day5::isValid(rules, manuals[idx]) ? valid : invalid).push_back(idx);
+
+  for (const auto chunk_size : {size_t{1}, size_t{7}, size_t{1024}}) {
+    const auto batch = Day5::classify(rules, manuals, 4, chunk_size);
+    EXPECT_EQ(batch.valid_middle_sum, 5374);
+    EXPECT_EQ(batch.reordered_middle_sum, 4260);
+    EXPECT_EQ(std::ranges::is_sorted(batch.valid), true);
+    EXPECT_EQ(std::ranges::is_sorted(batch.invalid), true);
+    EXPECT_EQ(batch.valid == valid, true);
+    EXPECT_EQ(batch.invalid == invalid, true);
+  }
 }
@@ -3,22 +3,28 @@
 // https://adventofcode.com/2024/day/6
 //
 
+#include <ranges>
+#include <vector>
+
+#include "headings.hh"
+#include "jump_table.hh"
 #include "map.hh"
 #include "state.hh"
 #include "testrunner/testrunner.h"
 #include "utils/coordinate.hh"
+#include "utils/coordinate_set.hh"
+#include "utils/coordinate_step.hh"
+#include "utils/parallel.hh"
 #include "utils/read_file.hh"
 
 namespace Day6 {
 
 [[nodiscard]] constexpr auto guardInBounds(const State& state) -> bool {
-  return state.guard.position.x >= 0 and
-         state.guard.position.x < state.map.size.x and  //
-         state.guard.position.y >= 0 and
-         state.guard.position.y < state.map.size.y;
+  return state.map.inBounds(state.guard.position);
 }
 
 void moveGuard(State& state) {
+  if (state.mode == Mode::Tracing) state.trail.push_back(state.guard);
   state.visited.insert(state.guard.position);
   auto new_position = state.guard.position + state.guard.direction;
   while (state.map.blocked.contains(new_position)) {
@@ -29,8 +35,7 @@ void moveGuard(State& state) {
 }
 
 [[nodiscard]] auto hasLooped(State& state) -> bool {
-  if (!state.visited.contains(state.guard.position)) state.travelled = 0;
-  return ++state.travelled == state.max_travel;
+  return !state.headings.insert(state.guard);
 }
 
 void spyOnTheGuard(State& state) {
@@ -53,6 +58,74 @@ void spyOnTheGuard(State& state) {
   }
 }
 
+// A single candidate's walk. The map and its jump table are shared and never
+// modified; the candidate obstruction is only overlaid, so probes can run on
+// any thread.
+struct Probe {
+  const Map* map;
+  const JumpTable* jumps;
+  Utils::Coordinate obstruction{};
+
+  Utils::Step start{};
+  Utils::Step guard{};
+  Headings turns{};
+
+  // Free cells ahead of the guard, cut short by the candidate obstruction
+  [[nodiscard]] constexpr auto freeAhead() const -> int {
+    const auto free   = jumps->freeAhead(guard);
+    const auto offset = obstruction - guard.position;
+    const auto along  = guard.direction.x != 0 ? offset.x * guard.direction.x
+                                               : offset.y * guard.direction.y;
+    const auto across = guard.direction.x != 0 ? offset.y : offset.x;
+    if (across != 0 or along < 1 or along > free) return free;
+    return along - 1;
+  }
+};
+
+// Jumps from turn to turn; the walk loops as soon as it repeats a turn.
+[[nodiscard]] auto loops(Probe& probe) -> bool {
+  probe.guard = probe.start;
+  probe.turns.reset(probe.map->size);
+
+  while (true) {
+    probe.guard.position += probe.guard.direction * probe.freeAhead();
+    if (!probe.map->inBounds(probe.guard.next())) return false;
+    if (!probe.turns.insert(probe.guard)) return true;
+    probe.guard.direction.rotateClockwise();
+  }
+}
+
+[[nodiscard]] auto probeInParallel(const State& state, const JumpTable& jumps,
+                                   size_t workers) -> size_t {
+  const auto queue = state.candidates | std::ranges::to<std::vector>();
+
+  const auto make_probe = [&] {
+    return [&, probe = Probe{.map = &state.map, .jumps = &jumps}](
+               size_t idx) mutable -> size_t {
+      probe.obstruction = queue[idx];
+      probe.start       = state.enteredFrom(probe.obstruction);
+      return loops(probe) ? 1 : 0;
+    };
+  };
+
+  return Utils::parallelSum<size_t>(queue.size(), make_probe, workers);
+}
+
+void spyOnTheGuardInParallel(State& state,
+                             size_t workers = Utils::hardwareThreads()) {
+  state.resetGuard();
+
+  // Part 1
+  while (guardInBounds(state)) moveGuard(state);
+
+  // Part 2
+  state.collectCandidates();
+  state.candidates_attempted = state.candidates.count();
+  state.obstruction_positions =
+      probeInParallel(state, JumpTable{state.map}, workers);
+  state.mode = Mode::Done;
+}
+
 }  // namespace Day6
 
 TEST(Day_06_Guard_Gallivant_SAMPLE) {
@@ -62,6 +135,12 @@ TEST(Day_06_Guard_Gallivant_SAMPLE) {
 
   EXPECT_EQ(state.candidates_attempted + 1, 41);
   EXPECT_EQ(state.obstruction_positions, 6);
+
+  auto parallel =
+      Day6::State{.map = Utils::readFileXY("06/sample.txt", Day6::Map{})};
+  Day6::spyOnTheGuardInParallel(parallel);
+  EXPECT_EQ(parallel.candidates_attempted, state.candidates_attempted);
+  EXPECT_EQ(parallel.obstruction_positions, state.obstruction_positions);
 }
 
 TEST(Day_06_Guard_Gallivant_FINAL) {
@@ -71,4 +150,10 @@ TEST(Day_06_Guard_Gallivant_FINAL) {
 
   EXPECT_EQ(state.candidates_attempted + 1, 5318);
   EXPECT_EQ(state.obstruction_positions, 1831);
+
+  auto parallel =
+      Day6::State{.map = Utils::readFileXY("06/input.txt", Day6::Map{})};
+  Day6::spyOnTheGuardInParallel(parallel);
+  EXPECT_EQ(parallel.candidates_attempted, state.candidates_attempted);
+  EXPECT_EQ(parallel.obstruction_positions, state.obstruction_positions);
 }
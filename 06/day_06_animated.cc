@@ -19,6 +19,7 @@ namespace Day6 {
 }
 
 void moveGuard(State& state) {
+  if (state.mode == Mode::Tracing) state.trail.push_back(state.guard);
   state.visited.insert(state.guard.position);
   auto new_position = state.guard.position + state.guard.direction;
   while (state.map.blocked.contains(new_position)) {
@@ -29,8 +30,7 @@ void moveGuard(State& state) {
 }
 
 [[nodiscard]] auto hasLooped(State& state) -> bool {
-  if (!state.visited.contains(state.guard.position)) state.travelled = 0;
-  return ++state.travelled == state.max_travel;
+  return !state.headings.insert(state.guard);
 }
 
 void animate(State& state) {
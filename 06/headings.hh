@@ -0,0 +1,54 @@
+#ifndef DAY_6_HEADINGS_HH
+#define DAY_6_HEADINGS_HH
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "utils/coordinate.hh"
+#include "utils/coordinate_directions.hh"
+#include "utils/coordinate_step.hh"
+
+namespace Day6 {
+
+// Directions the guard has faced on every cell during the current walk; a
+// walk that faces the same way on the same cell twice is a loop. Each cell
+// packs a 4 bit direction mask below the epoch of the walk that wrote it, so
+// starting a new walk is just bumping the epoch.
+class Headings {
+  static constexpr auto mask_bits = 4U;
+  static constexpr auto max_epoch =
+      std::numeric_limits<uint32_t>::max() >> mask_bits;
+
+  Utils::Coordinate size_{};
+  std::vector<uint32_t> cells_{};
+  uint32_t epoch_{};
+
+ public:
+  void reset(Utils::Coordinate size) {
+    if (size != size_ or epoch_ == max_epoch) {
+      size_ = size;
+      cells_.assign(static_cast<size_t>(size.x) * static_cast<size_t>(size.y),
+                    0);
+      epoch_ = 0;
+    }
+    ++epoch_;
+  }
+
+  // False if the guard already faced this way on this cell
+  [[nodiscard]] constexpr auto insert(Utils::Step step) -> bool {
+    auto& cell = cells_[static_cast<size_t>(step.position.y) *
+                            static_cast<size_t>(size_.x) +
+                        static_cast<size_t>(step.position.x)];
+    if ((cell >> mask_bits) != epoch_) cell = epoch_ << mask_bits;
+
+    const auto bit = 1U << Utils::Directions::orthagonalIndex(step.direction);
+    if ((cell & bit) != 0) return false;
+    cell |= bit;
+    return true;
+  }
+};
+
+}  // namespace Day6
+
+#endif  // DAY_6_HEADINGS_HH
@@ -0,0 +1,49 @@
+#ifndef DAY_6_JUMP_TABLE_HH
+#define DAY_6_JUMP_TABLE_HH
+
+#include <array>
+#include <cstdint>
+
+#include "map.hh"
+#include "utils/coordinate.hh"
+#include "utils/coordinate_directions.hh"
+#include "utils/coordinate_step.hh"
+#include "utils/grid.hh"
+
+namespace Day6 {
+
+// Number of free cells ahead of every cell, per direction, before the guard
+// runs into an obstacle or off the map. Counts are as wide as the int
+// coordinates, so no row or column is too long for them.
+class JumpTable {
+  Utils::Grid<std::array<uint32_t, 4>> free_ahead_;
+
+ public:
+  explicit JumpTable(const Map& map)
+      : free_ahead_{static_cast<size_t>(map.size.x),
+                    static_cast<size_t>(map.size.y)} {
+    for (const auto direction : Utils::Directions::orthagonal()) {
+      const auto idx = Utils::Directions::orthagonalIndex(direction);
+
+      // Walk backwards from every edge cell the guard would leave through
+      for (const auto edge : free_ahead_.coordinates()) {
+        if (map.inBounds(edge + direction)) continue;
+        auto free = uint32_t{};
+        for (auto at = edge; map.inBounds(at); at -= direction) {
+          free_ahead_[at][idx] = free;
+          free                 = map.blocked.contains(at) ? 0U : free + 1U;
+        }
+      }
+    }
+  }
+
+  [[nodiscard]] constexpr auto freeAhead(Utils::Step from) const -> int {
+    return static_cast<int>(
+        free_ahead_[from.position]
+                   [Utils::Directions::orthagonalIndex(from.direction)]);
+  }
+};
+
+}  // namespace Day6
+
+#endif  // DAY_6_JUMP_TABLE_HH
@@ -13,6 +13,10 @@ struct Map {
 
   static constexpr auto start_direction = Utils::Coordinate{0, -1};
 
+  [[nodiscard]] constexpr auto inBounds(Utils::Coordinate at) const -> bool {
+    return at.x >= 0 and at.x < size.x and at.y >= 0 and at.y < size.y;
+  }
+
   // NOLINTNEXTLINE
   void operator()(std::size_t x, std::size_t y, char chr) {
     const auto pos =
@@ -2,7 +2,9 @@
 #define DAY_6_STATE_HH
 
 #include <cstdint>
+#include <vector>
 
+#include "headings.hh"
 #include "map.hh"
 #include "utils/coordinate.hh"
 #include "utils/coordinate_set.hh"
@@ -19,6 +21,12 @@ struct State {
   Utils::Step guard{};
 
   Utils::CoordinateSet visited{};
+  Headings headings{};
+
+  // Part 1 route, one checkpoint per step, and the checkpoint right before
+  // the guard first enters each cell
+  std::vector<Utils::Step> trail{};
+  std::vector<Utils::Step> entered_from{};
   Utils::CoordinateSet candidates{};
   Utils::CoordinateSet::Iterator next_candidate{};
 
@@ -26,26 +34,54 @@ struct State {
 
   size_t candidates_attempted{1};
   size_t obstruction_positions{};
-  size_t travelled{};
-  size_t max_travel{};
 
   void resetGuard() {
     guard.position  = map.guard;
     guard.direction = Map::start_direction;
     visited         = {};
-    travelled       = {};
+    headings.reset(map.size);
   }
 
-  void switchToProbing() {
-    max_travel = visited.count();
+  // Up to the candidate, the walk is the same as in part 1
+  void resumeGuard() {
+    guard   = enteredFrom(candidate_at);
+    visited = {};
+    headings.reset(map.size);
+  }
+
+  [[nodiscard]] constexpr auto cellOf(Utils::Coordinate at) const -> size_t {
+    return static_cast<size_t>(at.y) * static_cast<size_t>(map.size.x) +
+           static_cast<size_t>(at.x);
+  }
+
+  [[nodiscard]] constexpr auto enteredFrom(Utils::Coordinate at) const
+      -> const Utils::Step& {
+    return entered_from[cellOf(at)];
+  }
+
+  void collectCandidates() {
     candidates = visited;
     candidates.erase(map.guard);
+
+    entered_from.assign(
+        static_cast<size_t>(map.size.x) * static_cast<size_t>(map.size.y), {});
+    auto entered = Utils::CoordinateSet{map.guard};
+    for (size_t step = 1; step < trail.size(); ++step) {
+      const auto at = trail[step].position;
+      if (entered.contains(at)) continue;
+      entered.insert(at);
+      entered_from[cellOf(at)] = trail[step - 1];
+    }
+  }
+
+  void switchToProbing() {
+    collectCandidates();
     next_candidate = candidates.begin();
 
     mode         = Mode::Probing;
     candidate_at = *next_candidate;
     map.blocked.insert(candidate_at);
-    resetGuard();
+    resumeGuard();
   }
 
   void nextCandidate() {
@@ -54,7 +90,7 @@ struct State {
       ++candidates_attempted;
       candidate_at = *next_candidate;
       map.blocked.insert(candidate_at);
-      resetGuard();
+      resumeGuard();
     }
   };
 
@@ -7,85 +7,148 @@
 
 #include <algorithm>  // IWYU pragma: keep
 #include <array>
+#include <limits>
+#include <optional>
 #include <ranges>
+#include <span>
+#include <tuple>
 #include <vector>
 
 #include "testrunner/testrunner.h"
+#include "utils/charconv.hh"
+#include "utils/digits.hh"
+#include "utils/jagged_array.hh"
+#include "utils/parallel.hh"
 #include "utils/read_file.hh"
 #include "utils/split.hh"
-#include "utils/sum.hh"
 
 namespace Day7 {
 
-using Equation  = std::vector<uint64_t>;
-using Equations = std::vector<Equation>;
+using Equation  = std::span<const uint64_t>;
+using Equations = Utils::JaggedArray<uint64_t>;
 
 [[nodiscard]] auto calibrationEquations(const std::filesystem::path& path)
     -> Equations {
-  return Utils::readLines(path)  //
-         | std::views::transform([](const auto& line) {
-             return Utils::split<uint64_t>(line, " ");
-           })  //
-         | std::ranges::to<std::vector>();
+  return Utils::splitLines<uint64_t>(Utils::readLines(path), " ");
 }
 
-// NOLINTNEXTLINE
-[[nodiscard]] constexpr auto Confabulate(uint64_t a, uint64_t b) -> uint64_t {
-  if (b == 0) return a * 10ULL;
-  auto digits = std::array<uint8_t, 20>{};  // Max digits in U64
-  auto* digit = digits.begin();
-  while (b != 0) {
-    *digit++ = static_cast<uint8_t>(b % 10);
-    b /= 10ULL;
+// Inverse operators: the value the operands to the left of `operand` have to
+// produce for the equation to still come out at `solution`, if there is one.
+struct Subtract {
+  [[nodiscard]] constexpr auto operator()(uint64_t solution, uint64_t operand)
+      const -> std::optional<uint64_t> {
+    if (solution < operand) return std::nullopt;
+    return solution - operand;
   }
+};
 
-  return std::ranges::fold_left(
-      std::ranges::subrange(digits.begin(), digit) | std::views::reverse, a,
-      [](auto acc, auto dig) { return acc * 10ULL + dig; });
-}
+struct Divide {
+  [[nodiscard]] constexpr auto operator()(uint64_t solution, uint64_t operand)
+      const -> std::optional<uint64_t> {
+    if (operand == 0 or solution % operand != 0) return std::nullopt;
+    return solution / operand;
+  }
+
+  // Multiplying by zero gives zero whatever the operands to the left produce,
+  // so there is no single value to divide back to
+  [[nodiscard]] static constexpr auto absorbs(uint64_t solution,
+                                              uint64_t operand) -> bool {
+    return operand == 0 and solution == 0;
+  }
+};
 
+struct Deconfabulate {
+  [[nodiscard]] constexpr auto operator()(uint64_t solution, uint64_t operand)
+      const -> std::optional<uint64_t> {
+    const auto digits = Utils::countDigits(operand);
+    if (digits == Utils::max_digits) return std::nullopt;  // No room left
+
+    const auto shift = Utils::pow10(digits);
+    if (solution % shift != operand) return std::nullopt;
+    return solution / shift;
+  }
+};
+
+// Solves right to left, undoing one operator at a time. Any branch that can't
+// be undone exactly is cut right away instead of at the end of the equation.
 template <typename... Ts>
-[[nodiscard]] constexpr auto tryOp(uint64_t solution, uint64_t accumulated,
-                                   auto operands, const auto& op,
-                                   const std::tuple<Ts...>& ops) -> bool {
-  accumulated = op(accumulated, operands.front());
-  if (operands.size() == 1) return accumulated == solution;
-  return (
-      tryOp(solution, accumulated, operands.next(), std::get<Ts>(ops), ops) or
-      ...);
+[[nodiscard]] constexpr auto undoOp(uint64_t solution,
+                                    std::span<const uint64_t> operands,
+                                    const auto& inverse,
+                                    const std::tuple<Ts...>& inverses) -> bool {
+  // There are always operands left of this one here
+  if constexpr (requires { inverse.absorbs(solution, operands.back()); }) {
+    if (inverse.absorbs(solution, operands.back())) return true;
+  }
+
+  const auto rest = inverse(solution, operands.back());
+  if (!rest) return false;
+
+  operands = operands.first(operands.size() - 1);
+  if (operands.size() == 1) return *rest == operands.front();
+  return (undoOp(*rest, operands, std::get<Ts>(inverses), inverses) or ...);
 }
 
 template <typename... Ts>
-[[nodiscard]] constexpr auto tryOps(const Equation& problem,
-                                    const std::tuple<Ts...>& ops) -> bool {
+[[nodiscard]] constexpr auto undoOps(Equation problem,
+                                     const std::tuple<Ts...>& inverses)
+    -> bool {
   if (problem.size() < 3) return false;
 
-  const auto solution    = problem.front();
-  const auto accumulated = *std::next(problem.begin());
-  const auto operands =
-      std::ranges::subrange(problem.begin() + 2, problem.end());
+  const auto solution = problem.front();
+  const auto operands = problem.subspan(1);
 
-  return (tryOp(solution, accumulated, operands, std::get<Ts>(ops), ops) or
+  return (undoOp(solution, operands, std::get<Ts>(inverses), inverses) or
           ...);
 }
 
-[[nodiscard]] auto fixPlusOrMultiplies(const Equation& problem) -> uint64_t {
-  const auto ops = std::tuple(std::plus{}, std::multiplies{});
-  return tryOps(problem, ops) ? problem.front() : 0U;
+[[nodiscard]] auto fixPlusOrMultiplies(Equation problem) -> uint64_t {
+  const auto inverses = std::tuple(Subtract{}, Divide{});
+  return undoOps(problem, inverses) ? problem.front() : 0U;
 }
 
-[[nodiscard]] auto alsoFixConcatenate(const Equation& problem) -> uint64_t {
-  const auto ops = std::tuple(std::plus{}, std::multiplies{}, &Confabulate);
-  return tryOps(problem, ops) ? problem.front() : 0U;
+[[nodiscard]] auto alsoFixConcatenate(Equation problem) -> uint64_t {
+  const auto inverses = std::tuple(Subtract{}, Divide{}, Deconfabulate{});
+  return undoOps(problem, inverses) ? problem.front() : 0U;
 }
 
-[[nodiscard]] auto calibrate(const Equations& problems,
-                             const auto& fn) -> uint64_t {
-  return Utils::sum(problems | std::views::transform(fn));
+// Equations differ wildly in cost, so they are handed out one at a time
+[[nodiscard]] auto calibrate(const Equations& problems, const auto& fn,
+                             size_t workers = Utils::hardwareThreads())
+    -> uint64_t {
+  const auto make_work = [&] {
+    return [&](size_t idx) { return fn(problems[idx]); };
+  };
+  return Utils::parallelSum<uint64_t>(problems.size(), make_work, workers);
 }
 
 }  // namespace Day7
 
+TEST(Day_07_Concatenation) {
+  for (const auto a : {0ULL, 1ULL, 9ULL, 10ULL, 12ULL, 999ULL, 1000ULL}) {
+    for (const auto b : {0ULL, 1ULL, 9ULL, 10ULL, 99ULL, 100ULL, 4567ULL}) {
+      const auto joined = Utils::concat(a, b);
+      EXPECT_EQ(joined, Utils::from_chars<uint64_t>(fmt::format("{}{}", a, b)));
+      EXPECT_EQ(Day7::Deconfabulate{}(joined, b), a);
+    }
+  }
+  EXPECT_EQ(Day7::Deconfabulate{}(1234, 35).has_value(), false);
+
+  const auto largest = std::numeric_limits<uint64_t>::max();
+  EXPECT_EQ(Utils::countDigits(largest), Utils::max_digits);
+  EXPECT_EQ(Utils::concat(0, largest), largest);
+  EXPECT_EQ(Day7::Deconfabulate{}(largest, largest).has_value(), false);
+}
+
+TEST(Day_07_Zero_Operand) {
+  const auto zero_last = std::array<uint64_t, 4>{7, 3, 0, 7};
+  EXPECT_EQ(Day7::fixPlusOrMultiplies(zero_last), 7);
+  const auto zero_inside = std::array<uint64_t, 5>{14, 9, 4, 0, 14};
+  EXPECT_EQ(Day7::fixPlusOrMultiplies(zero_inside), 14);
+  const auto unreachable = std::array<uint64_t, 4>{5, 5, 6, 0};
+  EXPECT_EQ(Day7::fixPlusOrMultiplies(unreachable), 0);
+}
+
 TEST(Day_07_Bridge_Repair_SAMPLE) {
   const auto equations = Day7::calibrationEquations("07/sample.txt");
   EXPECT_EQ(Day7::calibrate(equations, Day7::fixPlusOrMultiplies), 3749);
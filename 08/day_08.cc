@@ -4,96 +4,113 @@
 //
 
 #include <array>
+#include <bit>
+#include <cstdint>
 #include <fstream>
-#include <ranges>
+#include <utility>
 #include <vector>
 
 #include "testrunner/testrunner.h"
 #include "utils/coordinate.hh"
-#include "utils/coordinate_set.hh"
-#include "utils/curry.hh"
 #include "utils/grid.hh"
 
 namespace Day8 {
 
 using AntennaGrid = Utils::Grid<char>;
 
-[[nodiscard]] auto antiNodes(const AntennaGrid& grid) -> size_t {
-  const auto is_antenna = [&](auto coordinate) {
-    return grid[coordinate] != '.';
-  };
+// Antenna positions, bucketed by frequency, so pairs only ever come from
+// within one bucket
+struct Antennae {
+  Utils::Coordinate size{};
+  std::vector<std::vector<Utils::Coordinate>> frequencies{};
+
+  [[nodiscard]] static auto from(const AntennaGrid& grid) -> Antennae {
+    auto buckets = std::array<std::vector<Utils::Coordinate>, 256>{};
+    for (const auto at : grid.coordinates()) {
+      if (grid[at] != '.')
+        buckets[static_cast<unsigned char>(grid[at])].push_back(at);
+    }
 
-  const auto is_same_frequency = [&](auto first, auto second) {
-    return first != second and grid[first] == grid[second];
-  };
+    auto antennae = Antennae{.size = {.x = static_cast<int>(grid.width()),
+                                      .y = static_cast<int>(grid.height())}};
+    for (auto& bucket : buckets)
+      if (!bucket.empty()) antennae.frequencies.push_back(std::move(bucket));
+    return antennae;
+  }
+
+  [[nodiscard]] constexpr auto inBounds(Utils::Coordinate at) const -> bool {
+    return at.x >= 0 and at.x < size.x and at.y >= 0 and at.y < size.y;
+  }
+};
+
+// One bit per cell
+class BitGrid {
+  int width_{};
+  std::vector<uint64_t> bits_{};
+
+ public:
+  explicit BitGrid(Utils::Coordinate size)
+      : width_{size.x},
+        bits_((static_cast<size_t>(size.x) * static_cast<size_t>(size.y) + 63) /
+              64) {}
+
+  void mark(Utils::Coordinate at) {
+    const auto idx = static_cast<size_t>(at.y * width_ + at.x);
+    bits_[idx / 64] |= 1ULL << (idx % 64);
+  }
+
+  [[nodiscard]] auto count() const -> size_t {
+    auto count = size_t{};
+    for (const auto word : bits_)
+      count += static_cast<size_t>(std::popcount(word));
+    return count;
+  }
+};
+
+// Calls fn(first, second) for every ordered pair of antennae that share a
+// frequency
+void forEachPair(const Antennae& antennae, auto&& fn) {
+  for (const auto& bucket : antennae.frequencies) {
+    for (const auto first : bucket) {
+      for (const auto second : bucket)
+        if (first != second) fn(first, second);
+    }
+  }
+}
 
-  const auto antinodes_for = [&](auto first, auto second) {
-    const auto distance = second - first;
-    return std::array{first - distance, second + distance};
-  };
-
-  const auto in_bounds = [&](auto coordinate) {
-    return grid.inBounds(coordinate);
-  };
-
-  auto antennae = grid.coordinates() | std::views::filter(is_antenna);
-
-  const auto antinodes =
-      std::views::cartesian_product(antennae, antennae)        //
-      | std::views::filter(Utils::uncurry(is_same_frequency))  //
-      | std::views::transform(Utils::uncurry(antinodes_for))   //
-      | std::views::join                                       //
-      | std::views::filter(in_bounds)                          //
-      | std::ranges::to<Utils::CoordinateSet>();
+[[nodiscard]] auto antiNodes(const Antennae& antennae) -> size_t {
+  auto antinodes = BitGrid{antennae.size};
+  forEachPair(antennae, [&](auto first, auto second) {
+    const auto antinode = second + (second - first);
+    if (antennae.inBounds(antinode)) antinodes.mark(antinode);
+  });
   return antinodes.count();
 }
 
-[[nodiscard]] auto harmonicAntiNodes(const AntennaGrid& grid) -> size_t {
-  const auto is_antenna = [&](auto coordinate) {
-    return grid[coordinate] != '.';
-  };
-
-  const auto is_same_frequency = [&](auto first, auto second) {
-    return first != second and grid[first] == grid[second];
-  };
-
-  const auto antinodes_for = [&](auto first, auto second) {
-    auto nodes          = std::vector<Utils::Coordinate>{};
+[[nodiscard]] auto harmonicAntiNodes(const Antennae& antennae) -> size_t {
+  auto antinodes = BitGrid{antennae.size};
+  forEachPair(antennae, [&](auto first, auto second) {
     const auto distance = second - first;
-    while (grid.inBounds(first)) {
-      nodes.push_back(first);
-      first += distance;
-    }
-    while (grid.inBounds(second)) {
-      nodes.push_back(second);
-      second += distance;
-    }
-    return nodes;
-  };
-
-  auto antennae = grid.coordinates() | std::views::filter(is_antenna);
-
-  const auto antinodes =
-      std::views::cartesian_product(antennae, antennae)        //
-      | std::views::filter(Utils::uncurry(is_same_frequency))  //
-      | std::views::transform(Utils::uncurry(antinodes_for))   //
-      | std::views::join                                       //
-      | std::ranges::to<Utils::CoordinateSet>();
+    for (auto at = second; antennae.inBounds(at); at += distance)
+      antinodes.mark(at);
+  });
   return antinodes.count();
 }
 
 }  // namespace Day8
 
 TEST(Day_08_Resonant_Collinearity_SAMPLE) {
-  auto file       = std::ifstream("08/sample.txt");
-  const auto grid = Day8::AntennaGrid::from(file);
-  EXPECT_EQ(Day8::antiNodes(grid), 14);
-  EXPECT_EQ(Day8::harmonicAntiNodes(grid), 34);
+  auto file           = std::ifstream("08/sample.txt");
+  const auto grid     = Day8::AntennaGrid::from(file);
+  const auto antennae = Day8::Antennae::from(grid);
+  EXPECT_EQ(Day8::antiNodes(antennae), 14);
+  EXPECT_EQ(Day8::harmonicAntiNodes(antennae), 34);
 }
 
 TEST(Day_08_Resonant_Collinearity_FINAL) {
-  auto file       = std::ifstream("08/input.txt");
-  const auto grid = Day8::AntennaGrid::from(file);
-  EXPECT_EQ(Day8::antiNodes(grid), 336);
-  EXPECT_EQ(Day8::harmonicAntiNodes(grid), 1131);
+  auto file           = std::ifstream("08/input.txt");
+  const auto grid     = Day8::AntennaGrid::from(file);
+  const auto antennae = Day8::Antennae::from(grid);
+  EXPECT_EQ(Day8::antiNodes(antennae), 336);
+  EXPECT_EQ(Day8::harmonicAntiNodes(antennae), 1131);
 }
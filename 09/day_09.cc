@@ -4,7 +4,10 @@
 //
 
 #include <algorithm>
+#include <array>
 #include <filesystem>
+#include <functional>
+#include <queue>
 #include <ranges>
 #include <vector>
 
@@ -17,11 +20,6 @@ struct Block {
   bool empty{};
   int size{};
   uint64_t id{};
-
-  constexpr void clear() {
-    empty = true;
-    id    = {};
-  }
 };
 
 struct BlockMaker {
@@ -68,53 +66,129 @@ struct BlockMaker {
   return out;
 }
 
-[[nodiscard]] auto defrag(std::vector<Block> blocks) -> std::vector<Block> {
-  auto front = size_t{};
-  auto back  = blocks.size() - 1;
-
-  while (back > front) {
-    for (auto search = front; search < back; ++search) {
-      if (!blocks.at(search).empty) continue;
-
-      if (blocks.at(search).size == blocks.at(back).size) {
-        std::swap(blocks.at(search), blocks.at(back));
-        break;
-      }
-
-      if (blocks.at(search).size > blocks.at(back).size) {
-        blocks.at(search).size -= blocks.at(back).size;
-        blocks.insert(blocks.begin() + static_cast<int64_t>(search),
-                      blocks.at(back));
-        blocks.at(++back).clear();
-        break;
-      }
+// Moves every file, highest id first, into the leftmost gap that fits it.
+// Gaps are single digit sized and only ever shrink, so they are kept in a
+// min-heap of positions per size; the leftmost fitting gap is the smallest
+// top among the heaps for sizes no smaller than the file.
+[[nodiscard]] auto defrag(const std::vector<Block>& blocks)
+    -> std::vector<Block> {
+  struct File {
+    uint64_t position{};
+    Block block{};
+  };
+  using Gaps =
+      std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<>>;
+
+  // Positions are visited in order, so every list is already a valid heap
+  auto files     = std::vector<File>{};
+  auto positions = std::array<std::vector<uint64_t>, 10>{};
+  auto position  = uint64_t{};
+  for (const auto& block : blocks) {
+    if (!block.empty) files.push_back({.position = position, .block = block});
+    if (block.empty and block.size != 0)
+      positions[static_cast<size_t>(block.size)].push_back(position);
+    position += static_cast<uint64_t>(block.size);
+  }
+
+  auto gaps = std::array<Gaps, 10>{};
+  for (size_t size = 0; size != gaps.size(); ++size)
+    gaps[size] = Gaps{std::greater<>{}, std::move(positions[size])};
+
+  for (auto& file : files | std::views::reverse) {
+    const auto size = static_cast<size_t>(file.block.size);
+
+    auto best = gaps.size();
+    for (auto gap = size; gap != gaps.size(); ++gap) {
+      if (gaps[gap].empty() or gaps[gap].top() >= file.position) continue;
+      if (best == gaps.size() or gaps[gap].top() < gaps[best].top())
+        best = gap;
     }
+    if (best == gaps.size()) continue;
+
+    // The space the file leaves behind is right of every file still to move
+    file.position = gaps[best].top();
+    gaps[best].pop();
+    if (best > size) gaps[best - size].push(file.position + size);
+  }
 
-    while (blocks.at(--back).empty);
-    while (!blocks.at(front).empty) ++front;
+  std::ranges::sort(files, {}, &File::position);
+
+  auto out = std::vector<Block>{};
+  out.reserve(files.size() * 2);
+  position = 0;
+  for (const auto& file : files) {
+    if (file.position != position) {
+      out.push_back(
+          {.empty = true, .size = static_cast<int>(file.position - position)});
+    }
+    out.push_back(file.block);
+    position = file.position + static_cast<uint64_t>(file.block.size);
   }
-  return blocks;
+  return out;
 }
 
-[[nodiscard]] auto checksum(const std::vector<Block>& blocks) {
+// id * (position + ... + position + size - 1), as an arithmetic series
+[[nodiscard]] constexpr auto checksum(uint64_t position, const Block& block)
+    -> uint64_t {
+  const auto size = static_cast<uint64_t>(block.size);
+  return block.id * (size * position + size * (size - 1) / 2);
+}
+
+[[nodiscard]] auto checksum(const std::vector<Block>& blocks) -> uint64_t {
+  auto position = uint64_t{};
   return std::ranges::fold_left(
-      blocks.begin(), blocks.end(), 0U,
-      [pos = 0U](uint64_t accumulated, Block block) mutable {
-        while (block.size-- != 0) accumulated += pos++ * block.id;
+      blocks, uint64_t{}, [&](uint64_t accumulated, const Block& block) {
+        accumulated += checksum(position, block);
+        position += static_cast<uint64_t>(block.size);
         return accumulated;
       });
 }
 
+// Same walk as fragment(), but the blocks are compacted in place and summed
+// as they settle instead of being copied out
+[[nodiscard]] auto fragmentedChecksum(std::vector<Block> blocks) -> uint64_t {
+  auto accumulated = uint64_t{};
+  auto position    = uint64_t{};
+  const auto place = [&](const Block& block) {
+    accumulated += checksum(position, block);
+    position += static_cast<uint64_t>(block.size);
+  };
+
+  auto front = blocks.begin();
+  auto back  = blocks.end() - 1;
+
+  while (true) {
+    while (!front->empty) place(*front++);
+    while (back->empty) --back;
+    if (front >= back) break;
+
+    if (front->size >= back->size) {
+      place(*back);
+      front->size -= back->size;
+      --back;
+
+    } else {
+      place({.empty = false, .size = front->size, .id = back->id});
+      back->size -= front->size;
+      ++front;
+    }
+  }
+
+  return accumulated;
+}
+
 }  // namespace Day9
 
 TEST(Day_09_Disk_Fragmenter_SAMPLE) {
   const auto blocks = Day9::readBlocks("09/sample.txt");
   EXPECT_EQ(Day9::checksum(Day9::fragment(blocks)), 1928);
+  EXPECT_EQ(Day9::fragmentedChecksum(blocks), 1928);
   EXPECT_EQ(Day9::checksum(Day9::defrag(blocks)), 2858);
 }
 
 TEST(Day_09_Disk_Fragmenter_FINAL) {
   const auto blocks = Day9::readBlocks("09/input.txt");
   EXPECT_EQ(Day9::checksum(Day9::fragment(blocks)), 6242766523059ULL);
+  EXPECT_EQ(Day9::fragmentedChecksum(blocks), 6242766523059ULL);
   EXPECT_EQ(Day9::checksum(Day9::defrag(blocks)), 6272188244509ULL);
 }
@@ -5,15 +5,17 @@
 
 #include <fmt/core.h>
 
-#include <algorithm>  // IWYU pragma: keep
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <vector>
 
 #include "testrunner/testrunner.h"
 #include "utils/coordinate.hh"
-#include "utils/coordinate_set.hh"
 #include "utils/grid.hh"
-#include "utils/sum.hh"
 
 namespace Day10 {
 
@@ -26,47 +28,85 @@ using ElevationGrid =
   return ElevationGrid::from(file);
 }
 
-[[nodiscard]] constexpr auto reachablePeaks(const ElevationGrid& grid)
-    -> size_t {
-  const auto is_head = [&](auto coordinate) { return grid[coordinate] == '0'; };
-  const auto is_peak = [&](auto coordinate) { return grid[coordinate] == '9'; };
-
-  const auto peaks_reached = [&](this auto self, auto from) {
-    if (is_peak(from)) return std::vector<Utils::Coordinate>{from};
-    return from.orthogonalNeighbors()  //
-           | std::views::filter(
-                 [&](auto to) { return (grid[to] - grid[from]) == 1; })  //
-           | std::views::transform(self)                                 //
-           | std::views::join                                            //
-           | std::ranges::to<std::vector>();
-  };
+// Cells of every height, '0' through '9', so the trails can be walked one
+// layer at a time from the peaks down
+using Layers = std::array<std::vector<Utils::Coordinate>, 10>;
+
+[[nodiscard]] auto layers(const ElevationGrid& grid) -> Layers {
+  auto layers = Layers{};
+  for (const auto at : grid.coordinates()) {
+    const auto height = grid[at];
+    if (height >= '0' and height <= '9')
+      layers[static_cast<size_t>(height - '0')].push_back(at);
+  }
+  return layers;
+}
 
-  const auto unique_peaks = [&](auto peaks) {
-    return (peaks | std::ranges::to<Utils::CoordinateSet>()).count();
-  };
+[[nodiscard]] constexpr auto cellIndex(const ElevationGrid& grid,
+                                       Utils::Coordinate at) -> size_t {
+  return static_cast<size_t>(at.y) * grid.width() + static_cast<size_t>(at.x);
+}
 
-  return Utils::sum(grid.coordinates()                      //
-                    | std::views::filter(is_head)           //
-                    | std::views::transform(peaks_reached)  //
-                    | std::views::transform(unique_peaks));
+// Calls fn(from, to) for every step up from each cell of the layer
+constexpr void forEachStepUp(const ElevationGrid& grid,
+                             const std::vector<Utils::Coordinate>& layer,
+                             auto&& fn) {
+  for (const auto from : layer) {
+    for (const auto to : from.orthogonalNeighbors())
+      if (grid[to] - grid[from] == 1) fn(from, to);
+  }
 }
 
-[[nodiscard]] constexpr auto trailRatings(const ElevationGrid& grid) -> size_t {
-  const auto is_head = [&](auto coordinate) { return grid[coordinate] == '0'; };
-  const auto is_peak = [&](auto coordinate) { return grid[coordinate] == '9'; };
-
-  auto count_paths_to_top = [&](this auto self, auto from) {
-    if (is_peak(from)) return 1U;
-    return Utils::sum(from.orthogonalNeighbors()  //
-                      | std::views::filter([&](auto to) {
-                          return (grid[to] - grid[from]) == 1;
-                        })  //
-                      | std::views::transform(self));
+// Every cell keeps a bitset of the peaks it reaches, one bit per peak, which
+// is the union of the bitsets of the cells one step up. The peaks are taken
+// 64 at a time, so each cell needs a single word that is reused between
+// blocks, and memory stays linear in the size of the map.
+[[nodiscard]] auto reachablePeaks(const ElevationGrid& grid) -> size_t {
+  const auto by_height = layers(grid);
+  const auto& peaks    = by_height[9];
+
+  auto reached = std::vector<uint64_t>(grid.width() * grid.height());
+  const auto bits = [&](Utils::Coordinate at) -> uint64_t& {
+    return reached[cellIndex(grid, at)];
   };
 
-  return Utils::sum(grid.coordinates()             //
-                    | std::views::filter(is_head)  //
-                    | std::views::transform(count_paths_to_top));
+  auto score = size_t{};
+  for (size_t first = 0; first < peaks.size(); first += 64) {
+    for (const auto& layer : by_height)
+      for (const auto at : layer) bits(at) = 0;
+
+    const auto last = std::min(peaks.size(), first + 64);
+    for (auto peak = first; peak != last; ++peak)
+      bits(peaks[peak]) = uint64_t{1} << (peak - first);
+
+    for (auto height = by_height.size() - 1; height-- != 0;) {
+      forEachStepUp(grid, by_height[height],
+                    [&](auto from, auto to) { bits(from) |= bits(to); });
+    }
+
+    for (const auto head : by_height[0])
+      score += static_cast<size_t>(std::popcount(bits(head)));
+  }
+  return score;
+}
+
+// Every cell keeps the number of distinct trails from it to any peak, which
+// is the sum over the cells one step up
+[[nodiscard]] auto trailRatings(const ElevationGrid& grid) -> size_t {
+  const auto by_height = layers(grid);
+
+  auto paths = std::vector<size_t>(grid.width() * grid.height());
+  for (const auto peak : by_height[9]) paths[cellIndex(grid, peak)] = 1;
+
+  for (auto height = by_height.size() - 1; height-- != 0;) {
+    forEachStepUp(grid, by_height[height], [&](auto from, auto to) {
+      paths[cellIndex(grid, from)] += paths[cellIndex(grid, to)];
+    });
+  }
+
+  auto rating = size_t{};
+  for (const auto head : by_height[0]) rating += paths[cellIndex(grid, head)];
+  return rating;
 }
 
 }  // namespace Day10
@@ -0,0 +1,45 @@
+#ifndef DAY_11_BLINK_HH
+#define DAY_11_BLINK_HH
+
+#include <array>
+#include <cstdint>
+
+#include "utils/digits.hh"
+
+namespace Day11 {
+
+// The stones a single stone turns into after one blink
+struct Blink {
+  std::array<uint64_t, 2> stones{};
+  uint8_t count{};
+
+  [[nodiscard]] constexpr auto begin() const { return stones.begin(); }
+  [[nodiscard]] constexpr auto end() const { return stones.begin() + count; }
+};
+
+[[nodiscard]] constexpr auto blink(uint64_t stone) -> Blink {
+  if (stone == 0) return {.stones = {1, 0}, .count = 1};
+
+  if ((Utils::countDigits(stone) & 0x1) == 0) {
+    const auto [a, b] = Utils::splitHalves(stone);
+    return {.stones = {a, b}, .count = 2};
+  }
+
+  return {.stones = {stone * 2024, 0}, .count = 1};
+}
+
+// After a few blinks most stones carry small values, so those are looked up
+inline constexpr auto small_blinks = [] {
+  auto blinks = std::array<Blink, 1024>{};
+  for (size_t stone = 0; stone != blinks.size(); ++stone)
+    blinks[stone] = blink(stone);
+  return blinks;
+}();
+
+[[nodiscard]] constexpr auto blinkAt(uint64_t stone) -> Blink {
+  return stone < small_blinks.size() ? small_blinks[stone] : blink(stone);
+}
+
+}  // namespace Day11
+
+#endif  // DAY_11_BLINK_HH
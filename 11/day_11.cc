@@ -6,87 +6,79 @@
 #include <fmt/core.h>
 #include <fmt/ranges.h>
 
-#include <algorithm>
-#include <cmath>
 #include <string_view>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "stone_counter.hh"
+#include "stone_graph.hh"
+#include "stone_simulator.hh"
 #include "testrunner/testrunner.h"
 #include "utils/charconv.hh"
+#include "utils/digits.hh"
 #include "utils/read_file.hh"
 #include "utils/split.hh"
 
 namespace Day11 {
 
-template <typename T>
-[[nodiscard]] constexpr auto countDigits(T number) -> uint8_t {
-  if (number < 10) return 1;
-  auto count = uint8_t{};
-  while (number != 0) {
-    number /= 10;
-    ++count;
-  }
-  return count;
-}
-
-using StoneCount = std::unordered_map<uint64_t, size_t>;
-
 [[nodiscard]] auto countsFromFile(const std::filesystem::path& path)
-    -> StoneCount {
+    -> StoneCounter {
   const auto stones =
       Utils::split<uint64_t>(Utils::readLines(path).front(), " ");
-  auto counts = StoneCount{};
-  for (const auto& stone : stones) ++counts[stone];
+  auto counts = StoneCounter{stones.size()};
+  for (const auto& stone : stones) counts.add(stone, 1);
   return counts;
 }
 
-[[nodiscard]] constexpr auto split(uint64_t number)
-    -> std::pair<uint64_t, uint64_t> {
-  const auto chars = std::string_view{fmt::format("{}", number)};
-  return {Utils::from_chars<uint64_t>(chars.substr(0, chars.length() / 2)),
-          Utils::from_chars<uint64_t>(chars.substr(chars.length() / 2))};
+[[nodiscard]] auto transformStones(StoneCounter counts, size_t blinks)
+    -> size_t {
+  return StoneSimulator{std::move(counts)}.advance(blinks).count();
 }
 
-[[nodiscard]] auto transformStones(StoneCount counts, size_t blinks) -> size_t {
-  auto buffer = StoneCount{};
-  auto& in    = counts;
-  auto& out   = buffer;
-
-  while (blinks-- != 0) {
-    out.clear();
-
-    for (const auto& [id, count] : in) {
-      if (id == 0) {
-        out[1] += count;
+}  // namespace Day11
 
-      } else if ((countDigits(id) & 0x1) == 0) {
-        const auto [a, b] = split(id);
-        out[a] += count;
-        out[b] += count;
+TEST(Day_11_Digits) {
+  auto numbers = std::vector<uint64_t>{0, UINT64_MAX};
+  for (size_t exponent = 0; exponent != 20; ++exponent) {
+    const auto power = Utils::pow10(exponent);
+    numbers.insert(numbers.end(), {power - 1, power, power + 1, power * 5});
+  }
 
-      } else {
-        out[id * 2024] += count;
-      }
-    }
+  for (const auto number : numbers) {
+    const auto chars = fmt::format("{}", number);
+    EXPECT_EQ(Utils::countDigits(number), chars.length());
+    if (chars.length() % 2 != 0) continue;
 
-    std::swap(in, out);
+    const auto half = std::string_view{chars}.substr(0, chars.length() / 2);
+    const auto rest = std::string_view{chars}.substr(chars.length() / 2);
+    EXPECT_EQ(Utils::splitHalves(number),
+              std::pair(Utils::from_chars<uint64_t>(half),
+                        Utils::from_chars<uint64_t>(rest)));
   }
-
-  return std::ranges::fold_left(in, 0U, [](auto counts, const auto& tuple) {
-    return counts + std::get<1>(tuple);
-  });
 }
 
-}  // namespace Day11
-
 TEST(Day_11_Plutonian_Pebbles_SAMPLE) {
   const auto counts = Day11::countsFromFile("11/sample.txt");
   EXPECT_EQ(Day11::transformStones(counts, 6), 22);
   EXPECT_EQ(Day11::transformStones(counts, 25), 55312);
+
+  const auto graph = Day11::StoneGraph{counts};
+  EXPECT_EQ(graph.countModulo(25), 55312);
+  EXPECT_EQ(graph.countModulo(1'000'000), 368670021);
 }
 
 TEST(Day_11_Plutonian_Pebbles_FINAL) {
   const auto counts = Day11::countsFromFile("11/input.txt");
-  EXPECT_EQ(Day11::transformStones(counts, 25), 204022);
-  EXPECT_EQ(Day11::transformStones(counts, 75), 241651071960597);
+  auto simulator    = Day11::StoneSimulator{counts};
+  EXPECT_EQ(simulator.advance(25).count(), 204022);
+
+  const auto at_25 = simulator.snapshot();
+  EXPECT_EQ(simulator.advance(50).count(), 241651071960597);
+  EXPECT_EQ(simulator.blinks(), 75);
+  EXPECT_EQ(at_25.blinks(), 25);
+  EXPECT_EQ(at_25.count(), 204022);
+
+  const auto graph = Day11::StoneGraph{counts};
+  EXPECT_EQ(graph.countModulo(75), 241651071960597ULL % Day11::modulus);
+  EXPECT_EQ(graph.countModulo(1'000'000), 271080452);
 }
@@ -0,0 +1,81 @@
+#ifndef DAY_11_STONE_COUNTER_HH
+#define DAY_11_STONE_COUNTER_HH
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace Day11 {
+
+// Number of stones per engraved value, in one flat open addressed table. A
+// slot without stones is free, so clearing never has to touch the values.
+class StoneCounter {
+  std::vector<uint64_t> stones_;
+  std::vector<size_t> counts_;
+  size_t size_{};
+  int shift_{};
+
+  [[nodiscard]] constexpr auto slotOf(uint64_t stone) const -> size_t {
+    return static_cast<size_t>((stone * 0x9E37'79B9'7F4A'7C15ULL) >> shift_);
+  }
+
+  void grow() {
+    auto old_stones = std::move(stones_);
+    auto old_counts = std::move(counts_);
+    reset(old_counts.size());
+    for (size_t slot = 0; slot != old_counts.size(); ++slot)
+      add(old_stones[slot], old_counts[slot]);
+  }
+
+ public:
+  explicit StoneCounter(size_t expected = 0) { reset(expected); }
+
+  // Drops all stones and makes room for `expected` distinct values
+  void reset(size_t expected) {
+    const auto capacity = std::bit_ceil(std::max(expected * 2, size_t{16}));
+    if (capacity != counts_.size()) {
+      stones_.assign(capacity, 0);
+      counts_.assign(capacity, 0);
+    } else {
+      std::ranges::fill(counts_, 0);
+    }
+    size_  = 0;
+    shift_ = 64 - std::countr_zero(capacity);
+  }
+
+  void add(uint64_t stone, size_t count) {
+    if (count == 0) return;
+    if ((size_ + 1) * 2 > counts_.size()) grow();
+
+    const auto mask = counts_.size() - 1;
+    for (auto slot = slotOf(stone);; slot = (slot + 1) & mask) {
+      if (counts_[slot] == 0) {
+        stones_[slot] = stone;
+        counts_[slot] = count;
+        ++size_;
+        return;
+      }
+      if (stones_[slot] == stone) {
+        counts_[slot] += count;
+        return;
+      }
+    }
+  }
+
+  // Number of distinct values
+  [[nodiscard]] constexpr auto size() const -> size_t { return size_; }
+
+  [[nodiscard]] constexpr auto total() const -> size_t {
+    return std::ranges::fold_left(counts_, size_t{}, std::plus{});
+  }
+
+  constexpr void forEach(auto&& fn) const {
+    for (size_t slot = 0; slot != counts_.size(); ++slot)
+      if (counts_[slot] != 0) fn(stones_[slot], counts_[slot]);
+  }
+};
+
+}  // namespace Day11
+
+#endif  // DAY_11_STONE_COUNTER_HH
@@ -0,0 +1,222 @@
+#ifndef DAY_11_STONE_GRAPH_HH
+#define DAY_11_STONE_GRAPH_HH
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "blink.hh"
+#include "stone_counter.hh"
+
+namespace Day11 {
+
+// Stone counts grow by about half every blink, so they outgrow any fixed
+// width integer after a few hundred blinks; past that they are only
+// reported modulo this prime.
+inline constexpr auto modulus = uint64_t{1'000'000'007};
+
+namespace Detail {
+
+[[nodiscard]] constexpr auto addMod(uint64_t a, uint64_t b) -> uint64_t {
+  return (a + b) % modulus;
+}
+
+[[nodiscard]] constexpr auto subMod(uint64_t a, uint64_t b) -> uint64_t {
+  return (a + modulus - b) % modulus;
+}
+
+[[nodiscard]] constexpr auto mulMod(uint64_t a, uint64_t b) -> uint64_t {
+  return a * b % modulus;
+}
+
+[[nodiscard]] constexpr auto inverseMod(uint64_t a) -> uint64_t {
+  auto inverse = uint64_t{1};
+  for (auto exponent = modulus - 2; exponent != 0; exponent >>= 1U) {
+    if ((exponent & 1U) != 0) inverse = mulMod(inverse, a);
+    a = mulMod(a, a);
+  }
+  return inverse;
+}
+
+// Shortest linear recurrence that generates `sequence`, as the weights of the
+// previous terms: s[n] = weights[0] * s[n - 1] + weights[1] * s[n - 2] + ...
+[[nodiscard]] inline auto berlekampMassey(
+    const std::vector<uint64_t>& sequence) -> std::vector<uint64_t> {
+  auto current      = std::vector<uint64_t>{1};
+  auto previous     = std::vector<uint64_t>{1};
+  auto length       = size_t{};
+  auto shift        = size_t{1};
+  auto previous_gap = uint64_t{1};
+
+  for (size_t n = 0; n != sequence.size(); ++n) {
+    auto gap = sequence[n];
+    for (size_t i = 1; i <= length; ++i)
+      gap = addMod(gap, mulMod(current[i], sequence[n - i]));
+
+    if (gap == 0) {
+      ++shift;
+      continue;
+    }
+
+    const auto last  = current;
+    const auto scale = mulMod(gap, inverseMod(previous_gap));
+    if (current.size() < previous.size() + shift)
+      current.resize(previous.size() + shift);
+    for (size_t i = 0; i != previous.size(); ++i)
+      current[i + shift] =
+          subMod(current[i + shift], mulMod(scale, previous[i]));
+
+    if (2 * length <= n) {
+      length       = n + 1 - length;
+      previous     = last;
+      previous_gap = gap;
+      shift        = 1;
+    } else {
+      ++shift;
+    }
+  }
+
+  current.resize(length + 1);
+  auto weights = std::vector<uint64_t>(length);
+  for (size_t i = 0; i != length; ++i) weights[i] = subMod(0, current[i + 1]);
+  return weights;
+}
+
+// a * b as polynomials in x, reduced by the recurrence:
+// x^L = weights[0] x^(L-1) + ... + weights[L-1]
+[[nodiscard]] inline auto mulModRecurrence(const std::vector<uint64_t>& a,
+                                           const std::vector<uint64_t>& b,
+                                           const std::vector<uint64_t>& weights)
+    -> std::vector<uint64_t> {
+  const auto length = weights.size();
+  auto product      = std::vector<uint64_t>(2 * length - 1);
+  for (size_t i = 0; i != length; ++i) {
+    if (a[i] == 0) continue;
+    for (size_t j = 0; j != length; ++j)
+      product[i + j] = addMod(product[i + j], mulMod(a[i], b[j]));
+  }
+
+  for (auto power = product.size() - 1; power >= length; --power) {
+    const auto coefficient = product[power];
+    if (coefficient == 0) continue;
+    for (size_t i = 0; i != length; ++i)
+      product[power - 1 - i] = addMod(product[power - 1 - i],
+                                      mulMod(coefficient, weights[i]));
+  }
+
+  product.resize(length);
+  return product;
+}
+
+// a * x, reduced the same way
+[[nodiscard]] inline auto mulXModRecurrence(
+    const std::vector<uint64_t>& a, const std::vector<uint64_t>& weights)
+    -> std::vector<uint64_t> {
+  const auto length = weights.size();
+  auto product      = std::vector<uint64_t>(length);
+  for (size_t i = 0; i != length; ++i)
+    product[i] = mulMod(a[length - 1], weights[length - 1 - i]);
+  for (size_t i = 1; i != length; ++i)
+    product[i] = addMod(product[i], a[i - 1]);
+  return product;
+}
+
+}  // namespace Detail
+
+// Every value that can ever be engraved on a stone starting from the seeds,
+// which turns out to be a small closed set, with the values each one turns
+// into. Blinking is then a fixed sparse linear map on the counts per value.
+class StoneGraph {
+  std::vector<uint64_t> values_;
+  std::vector<std::array<uint32_t, 2>> next_;
+  std::vector<uint8_t> next_count_;
+  std::vector<uint64_t> seed_counts_;  // Modulo `modulus`
+
+  // Total number of stones after 0, 1, ... `blinks` - 1 blinks, modulo
+  // `modulus`
+  [[nodiscard]] auto totals(size_t blinks) const -> std::vector<uint64_t> {
+    auto totals  = std::vector<uint64_t>{};
+    auto current = seed_counts_;
+    auto next    = std::vector<uint64_t>(values_.size());
+
+    for (size_t blink = 0; blink != blinks; ++blink) {
+      auto total = uint64_t{};
+      for (const auto count : current) total = Detail::addMod(total, count);
+      totals.push_back(total);
+
+      std::ranges::fill(next, 0);
+      for (size_t value = 0; value != values_.size(); ++value) {
+        for (size_t i = 0; i != next_count_[value]; ++i) {
+          auto& count = next[next_[value][i]];
+          count       = Detail::addMod(count, current[value]);
+        }
+      }
+      std::swap(current, next);
+    }
+
+    return totals;
+  }
+
+ public:
+  explicit StoneGraph(const StoneCounter& seeds) {
+    auto index_of = std::unordered_map<uint64_t, uint32_t>{};
+    const auto index = [&](uint64_t value) {
+      const auto [it, inserted] =
+          index_of.try_emplace(value, static_cast<uint32_t>(values_.size()));
+      if (inserted) values_.push_back(value);
+      return it->second;
+    };
+
+    seeds.forEach([&](uint64_t stone, size_t) { index(stone); });
+    for (size_t value = 0; value != values_.size(); ++value) {
+      auto next  = std::array<uint32_t, 2>{};
+      auto count = uint8_t{};
+      for (const auto stone : blinkAt(values_[value]))
+        next[count++] = index(stone);
+      next_.push_back(next);
+      next_count_.push_back(count);
+    }
+
+    seed_counts_.resize(values_.size());
+    seeds.forEach([&](uint64_t stone, size_t count) {
+      seed_counts_[index_of.at(stone)] = count % modulus;
+    });
+  }
+
+  // Number of distinct values that stones can ever carry
+  [[nodiscard]] auto size() const -> size_t { return values_.size(); }
+
+  // Number of stones after `blinks` blinks, modulo `modulus`. The totals obey
+  // a linear recurrence no longer than the number of distinct values, so only
+  // twice that many blinks are simulated. The recurrence then jumps to the
+  // requested blink by repeated squaring of x modulo its polynomial.
+  [[nodiscard]] auto countModulo(uint64_t blinks) const -> uint64_t {
+    const auto needed = 2 * values_.size() + 1;
+    if (blinks < needed) return totals(static_cast<size_t>(blinks) + 1).back();
+
+    const auto sequence = totals(needed);
+    const auto weights  = Detail::berlekampMassey(sequence);
+    if (weights.empty()) return 0;
+
+    // x^blinks reduced by the recurrence, starting from x^0
+    auto power = std::vector<uint64_t>(weights.size());
+    power[0]   = 1;
+    for (auto bit = std::bit_width(blinks); bit-- != 0;) {
+      power = Detail::mulModRecurrence(power, power, weights);
+      if (((blinks >> bit) & 1U) != 0)
+        power = Detail::mulXModRecurrence(power, weights);
+    }
+
+    auto count = uint64_t{};
+    for (size_t i = 0; i != weights.size(); ++i)
+      count = Detail::addMod(count, Detail::mulMod(power[i], sequence[i]));
+    return count;
+  }
+};
+
+}  // namespace Day11
+
+#endif  // DAY_11_STONE_GRAPH_HH
@@ -0,0 +1,52 @@
+#ifndef DAY_11_STONE_SIMULATOR_HH
+#define DAY_11_STONE_SIMULATOR_HH
+
+#include <cstdint>
+#include <utility>
+
+#include "blink.hh"
+#include "stone_counter.hh"
+
+namespace Day11 {
+
+// The stones after some number of blinks, which can be blinked further at
+// any time. Copies are independent, so a snapshot can be resumed later or
+// from several places.
+class StoneSimulator {
+  StoneCounter stones_;
+  StoneCounter buffer_{};
+  size_t blinks_{};
+
+ public:
+  explicit StoneSimulator(StoneCounter stones) : stones_{std::move(stones)} {}
+
+  auto advance(size_t blinks) -> StoneSimulator& {
+    for (; blinks != 0; --blinks, ++blinks_) {
+      // Distinct values barely change in number from one blink to the next
+      buffer_.reset(stones_.size());
+      stones_.forEach([&](uint64_t stone, size_t count) {
+        for (const auto next : blinkAt(stone)) buffer_.add(next, count);
+      });
+      std::swap(stones_, buffer_);
+    }
+    return *this;
+  }
+
+  // Blinks so far
+  [[nodiscard]] constexpr auto blinks() const -> size_t { return blinks_; }
+
+  // Number of stones
+  [[nodiscard]] constexpr auto count() const -> size_t {
+    return stones_.total();
+  }
+
+  [[nodiscard]] constexpr auto stones() const -> const StoneCounter& {
+    return stones_;
+  }
+
+  [[nodiscard]] auto snapshot() const -> StoneSimulator { return *this; }
+};
+
+}  // namespace Day11
+
+#endif  // DAY_11_STONE_SIMULATOR_HH
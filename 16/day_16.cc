@@ -4,9 +4,12 @@
 //
 
 #include <algorithm>  // IWYU pragma: keep
+#include <array>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
-#include <limits>
+#include <ranges>
+#include <span>
 #include <vector>
 
 #include "testrunner/testrunner.h"
@@ -14,80 +17,218 @@
 #include "utils/coordinate_directions.hh"
 #include "utils/coordinate_set.hh"
 #include "utils/coordinate_step.hh"
-#include "utils/coordinate_step_map.hh"  // IWYU pragma: keep
 #include "utils/dijkstras.hh"
 #include "utils/grid.hh"
+#include "utils/junction_graph.hh"
 
 namespace Day16 {
 
-using Map  = Utils::Grid<char>;
-using Edge = Utils::WeightedEdge<int, Utils::Step>;
+using Map   = Utils::Grid<char>;
+using Edge  = Utils::WeightedEdge<int, Utils::Step>;
+using Move  = Utils::TaggedEdge<int, Utils::Step>;
+using Paths = Utils::ShortestPaths<int, Utils::Step>;
+using Steps = std::vector<Utils::Step>;
+
+enum Tag : uint8_t { Forward, TurnedCounterClockwise, TurnedClockwise };
+
+constexpr auto DIRECTIONS = size_t{4};
 
 [[nodiscard]] auto loadMap(const std::filesystem::path& path) -> Map {
   auto map_file = std::ifstream(path);
   return Map::from(map_file);
 }
 
-[[nodiscard]] auto findPath(const Map& map) {
+[[nodiscard]] constexpr auto stateOf(const Map& map,
+                                     Utils::Step step) -> size_t {
+  const auto cell = static_cast<size_t>(step.position.y) * map.width() +
+                    static_cast<size_t>(step.position.x);
+  return cell * DIRECTIONS + Utils::Directions::orthagonalIndex(step.direction);
+}
+
+[[nodiscard]] constexpr auto stepOf(const Map& map,
+                                    size_t state) -> Utils::Step {
+  const auto cell = state / DIRECTIONS;
+  return {.position  = {static_cast<int>(cell % map.width()),
+                        static_cast<int>(cell / map.width())},
+          .direction = Utils::Directions::orthagonal()[state % DIRECTIONS]};
+}
+
+[[nodiscard]] constexpr auto predecessorOf(const Map& map, size_t state,
+                                           Tag tag) -> size_t {
+  const auto step = stepOf(map, state);
+  switch (tag) {
+    case Tag::Forward:
+      return stateOf(map, {step.position - step.direction, step.direction});
+    case Tag::TurnedCounterClockwise:
+      return stateOf(map,
+                     {step.position, Utils::rotatedClockwise(step.direction)});
+    case Tag::TurnedClockwise:
+      return stateOf(map, {step.position,
+                           Utils::rotatedCounterClockwise(step.direction)});
+  }
+  return state;
+}
+
+[[nodiscard]] auto startOf(const Map& map) -> Edge {
   const auto start = map.find('S').value_or(Utils::Coordinate{});
-  const auto start_edge =
-      Edge{0, Utils::Step{start, Utils::Direction::right()}};
+  return Edge{0, Utils::Step{start, Utils::Direction::right()}};
+}
+
+// Every direction the reindeer can arrive at 'E' from is a search target.
+[[nodiscard]] auto finishesOf(const Map& map) -> Steps {
+  const auto finish   = map.find('E').value_or(Utils::Coordinate{});
+  const auto can_come = [&](auto direction) {
+    return map[finish - direction] != '#';
+  };
+  const auto arrive = [&](auto direction) {
+    return Utils::Step{finish, direction};
+  };
+  return Utils::Directions::orthagonal()  //
+         | std::views::filter(can_come)   //
+         | std::views::transform(arrive)  //
+         | std::ranges::to<std::vector>();
+}
+
+// Seeds the backtracking with every finish tied for the shortest distance.
+void markFinishes(Paths& paths, const Steps& finishes, auto&& state_of) {
+  for (const auto& finish : finishes) {
+    const auto state = state_of(finish);
+    if (paths.distances[state] == paths.nearest->distance)
+      paths.previous[state] |= Paths::on_path;
+  }
+}
+
+[[nodiscard]] auto findPath(const Map& map, const Steps& finishes) -> Paths {
+  const auto start_edge = startOf(map);
+
+  const auto state_of = [&](const auto& step) { return stateOf(map, step); };
 
   const auto adjacent = [&](const auto& from) {
-    const auto edges = {
-        Edge{1, {from.next(), from.direction}},
-        {1000, {from.position, Utils::rotatedCounterClockwise(from.direction)}},
-        {1000, {from.position, Utils::rotatedClockwise(from.direction)}}};
-    const auto in_bounds = [&](auto to) {
-      return map[to.distance == 1 ? from.next() : to.edge.next()] != '#';
+    const auto in_bounds = [&map, from](auto to) {
+      return map[to.tag == Tag::Forward ? from.next() : to.edge.next()] != '#';
     };
-    return edges | std::views::filter(in_bounds) |
-           std::ranges::to<std::vector>();
+    return std::array{
+               Move{1, {from.next(), from.direction}, Tag::Forward},
+               Move{1000,
+                    {from.position,
+                     Utils::rotatedCounterClockwise(from.direction)},
+                    Tag::TurnedCounterClockwise},
+               Move{1000,
+                    {from.position, Utils::rotatedClockwise(from.direction)},
+                    Tag::TurnedClockwise}} |
+           std::views::filter(in_bounds);
   };
 
-  return Utils::dijkstra<int, Utils::Step>(start_edge, adjacent);
+  return Utils::dijkstra<int, Utils::Step>(
+      std::span{&start_edge, 1}, finishes, Utils::Settle::NearestTargets,
+      map.width() * map.height() * DIRECTIONS, state_of, adjacent);
 }
 
-[[nodiscard]] constexpr auto bestSeats(Utils::Step finish,
-                                       const auto& previous) -> size_t {
-  auto stack   = std::vector<Utils::Step>{finish};
-  auto visited = std::unordered_set<Utils::Step>{finish};
-  auto unique  = Utils::CoordinateSet{finish.position};
-  while (!stack.empty() and previous.contains(stack.front())) {
-    const auto to = stack.front();
-    stack.erase(stack.begin());
-
-    for (const auto& previous_edge : previous.at(to)) {
-      if (!visited.contains(previous_edge)) {
-        visited.insert(previous_edge);
-        stack.push_back(previous_edge);
-        unique.insert(previous_edge.position);
-      }
+[[nodiscard]] auto bestSeats(const Map& map, Paths& paths,
+                             const Steps& finishes) -> size_t {
+  markFinishes(paths, finishes,
+               [&](const auto& step) { return stateOf(map, step); });
+
+  // Predecessors always settle before their successors, so a single reverse
+  // sweep over the settle order marks every state on a shortest path.
+  for (const auto state : paths.settled | std::views::reverse) {
+    const auto mask = paths.previous[state];
+    if ((mask & Paths::on_path) == 0) continue;
+    for (const auto tag : {Tag::Forward, Tag::TurnedCounterClockwise,
+                           Tag::TurnedClockwise}) {
+      if ((mask & (1U << tag)) != 0)
+        paths.previous[predecessorOf(map, state, tag)] |= Paths::on_path;
     }
   }
-  return unique.count();
+
+  const auto state_on_path = [&](size_t state) {
+    return (paths.previous[state] & Paths::on_path) != 0;
+  };
+  const auto cell_on_path = [&](size_t cell) {
+    return std::ranges::any_of(
+        std::views::iota(cell * DIRECTIONS, (cell + 1) * DIRECTIONS),
+        state_on_path);
+  };
+  return static_cast<size_t>(std::ranges::count_if(
+      std::views::iota(size_t{}, map.width() * map.height()), cell_on_path));
 }
 
 [[nodiscard]] auto runMaze(const Map& map) -> std::pair<int, size_t> {
-  const auto [distances, previous] = findPath(map);
+  const auto finishes = finishesOf(map);
+  auto paths          = findPath(map, finishes);
+  if (!paths.nearest) return {};
+
+  return std::make_pair(paths.nearest->distance,
+                        bestSeats(map, paths, finishes));
+}
+
+[[nodiscard]] constexpr auto turnsBetween(Utils::Coordinate from,
+                                          Utils::Coordinate to) -> int {
+  const auto turns = (Utils::Directions::orthagonalIndex(to) + DIRECTIONS -
+                      Utils::Directions::orthagonalIndex(from)) %
+                     DIRECTIONS;
+  return static_cast<int>(turns == 3 ? 1 : turns);
+}
+
+// Same maze, but searched on the junction graph. A state is a junction and
+// the direction the reindeer faces on arrival; the tag of a move is the
+// direction it faced before leaving the previous junction.
+[[nodiscard]] auto runJunctionMaze(const Map& map) -> std::pair<int, size_t> {
+  const auto is_marker = [&](auto at) { return map[at] != '.'; };
+  const auto graph = Utils::contractMaze(map, '#', 1, 1000, is_marker);
 
-  const auto finish    = map.find('E').value_or(Utils::Coordinate{});
-  const auto is_finish = [&](auto weighted) {
-    return std::get<0>(weighted).position == finish;
+  const auto state_of = [&](const Utils::Step& step) {
+    return graph.junction_at[step.position] * DIRECTIONS +
+           Utils::Directions::orthagonalIndex(step.direction);
   };
 
-  const auto lowest = [](auto acc, auto edge) -> std::pair<Utils::Step, int> {
-    if (edge.second < acc.second) return edge;
-    return acc;
+  const auto adjacent = [&](const Utils::Step& from) {
+    const auto junction = graph.junction_at[from.position];
+    const auto is_open  = [&graph, junction](auto leaving) {
+      return graph.corridor(junction, leaving).to != graph.none;
+    };
+    const auto follow = [&graph, junction, from](auto leaving) {
+      const auto& corridor = graph.corridor(junction, leaving);
+      return Move{turnsBetween(from.direction, leaving) * 1000 +
+                      corridor.distance,
+                  {graph.junctions[corridor.to], corridor.arriving},
+                  static_cast<uint8_t>(
+                      Utils::Directions::orthagonalIndex(from.direction))};
+    };
+    return Utils::Directions::orthagonal()  //
+           | std::views::filter(is_open)    //
+           | std::views::transform(follow);
   };
 
-  const auto init =
-      std::make_pair(Utils::Step{}, std::numeric_limits<int>::max());
+  const auto start_edge = startOf(map);
+  const auto finishes   = finishesOf(map);
+  auto paths            = Utils::dijkstra<int, Utils::Step>(
+      std::span{&start_edge, 1}, finishes, Utils::Settle::NearestTargets,
+      graph.junctions.size() * DIRECTIONS, state_of, adjacent);
+  if (!paths.nearest) return {};
+
+  markFinishes(paths, finishes, state_of);
+
+  auto seats = Utils::CoordinateSet{};
+  for (const auto state : paths.settled | std::views::reverse) {
+    const auto mask = paths.previous[state];
+    if ((mask & Paths::on_path) == 0) continue;
+
+    const auto junction = state / DIRECTIONS;
+    seats.insert(graph.junctions[junction]);
+    if ((mask & ~Paths::on_path) == 0) continue;
+
+    const auto arriving = Utils::Directions::orthagonal()[state % DIRECTIONS];
+    const auto& back    = graph.corridor(junction, Utils::flipped(arriving));
+    for (const auto cell : graph.cellsOf(back)) seats.insert(cell);
+
+    for (size_t facing = 0; facing != DIRECTIONS; ++facing) {
+      if ((mask & (1U << facing)) != 0)
+        paths.previous[back.to * DIRECTIONS + facing] |= Paths::on_path;
+    }
+  }
 
-  auto finishes = distances | std::views::filter(is_finish);
-  const auto [min_at, min_distance] =
-      std::ranges::fold_left(finishes, init, lowest);
-  return std::make_pair(min_distance, bestSeats(min_at, previous));
+  return std::make_pair(paths.nearest->distance, seats.count());
 }
 
 }  // namespace Day16
@@ -97,6 +238,8 @@ TEST(Day_16_Reindeer_Maze_SAMPLE) {
       Day16::runMaze(Day16::loadMap("16/sample.txt"));
   EXPECT_EQ(distance, 11'048);
   EXPECT_EQ(best_seats, 64);
+  EXPECT_EQ(Day16::runJunctionMaze(Day16::loadMap("16/sample.txt")),
+            std::make_pair(distance, best_seats));
 }
 
 TEST(Day_16_Reindeer_Maze_FINAL) {
@@ -104,4 +247,6 @@ TEST(Day_16_Reindeer_Maze_FINAL) {
       Day16::runMaze(Day16::loadMap("16/input.txt"));
   EXPECT_EQ(distance, 83'432);
   EXPECT_EQ(best_seats, 467);
+  EXPECT_EQ(Day16::runJunctionMaze(Day16::loadMap("16/input.txt")),
+            std::make_pair(distance, best_seats));
 }
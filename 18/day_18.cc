@@ -5,6 +5,8 @@
 
 #include <filesystem>
 #include <ranges>
+#include <span>
+#include <vector>
 
 #include "testrunner/testrunner.h"
 #include "utils/coordinate.hh"
@@ -26,13 +28,8 @@ struct Map {
   size_t width;
 };
 
-[[nodiscard]] auto findEscapeLength(const Grid& grid) -> int {
-  const auto start      = Utils::Coordinate(0, 0);
-  const auto start_edge = Edge{0, start};
-  const auto target     = Utils::Coordinate{static_cast<int>(grid.width()) - 1,
-                                        static_cast<int>(grid.height()) - 1};
-
-  const auto adjacent = [&](const auto& from) {
+[[nodiscard]] auto adjacentOf(const Grid& grid) {
+  return [&grid](const auto& from) {
     const auto edges     = {Edge{1, from + Utils::Direction::up()},
                             Edge{1, from + Utils::Direction::down()},
                             Edge{1, from + Utils::Direction::left()},
@@ -41,8 +38,24 @@ struct Map {
     return edges | std::views::filter(in_bounds) |
            std::ranges::to<std::vector>();
   };
+}
+
+[[nodiscard]] auto findEscapeLength(const Grid& grid) -> int {
+  const auto start      = Utils::Coordinate(0, 0);
+  const auto start_edge = Edge{0, start};
+  const auto target     = Utils::Coordinate{static_cast<int>(grid.width()) - 1,
+                                        static_cast<int>(grid.height()) - 1};
+
+  return Utils::dijkstra<int, Utils::Coordinate>(start_edge, target,
+                                                 adjacentOf(grid));
+}
 
-  return Utils::dijkstra<int, Utils::Coordinate>(start_edge, target, adjacent);
+// Distances from the top left corner to each reachable target, nearest first
+[[nodiscard]] auto findLengths(const Grid& grid, const Chunks& targets,
+                               Utils::Settle settle) -> std::vector<Edge> {
+  const auto start_edge = Edge{0, Utils::Coordinate(0, 0)};
+  return Utils::dijkstra<int, Utils::Coordinate>(
+      std::span{&start_edge, 1}, std::span{targets}, settle, adjacentOf(grid));
 }
 
 [[nodiscard]] auto readChunks(const std::filesystem::path& path) -> Chunks {
@@ -99,6 +112,28 @@ TEST(Day_18_RAM_Run_SAMPLE) {
   EXPECT_EQ(Day18::trapped(map), Utils::Coordinate(6U, 1U));
 }
 
+TEST(Day_18_RAM_Run_Targets) {
+  const auto map = Day18::Map{Day18::readChunks("18/sample.txt"), 7U};
+  auto grid      = Day18::Grid{map.width, map.width};
+  for (size_t i = 0; i != 12; ++i) grid[map.chunks[i]] = '#';
+
+  const auto targets = Day18::Chunks{{6, 6}, {1, 0}, {0, 1}, {3, 3}};
+
+  const auto all = Day18::findLengths(grid, targets, Utils::Settle::AllTargets);
+  EXPECT_EQ(all.size(), 3);  // (3, 3) is walled off
+  EXPECT_EQ(all.front().distance, 1);
+  EXPECT_EQ(all.back().edge, Utils::Coordinate(6, 6));
+  EXPECT_EQ(all.back().distance, 22);
+
+  const auto nearest =
+      Day18::findLengths(grid, targets, Utils::Settle::NearestTargets);
+  EXPECT_EQ(nearest.size(), 2);
+  EXPECT_EQ(nearest.back().distance, 1);
+
+  const auto any = Day18::findLengths(grid, targets, Utils::Settle::AnyTarget);
+  EXPECT_EQ(any.size(), 1);
+}
+
 TEST(Day_18_RAM_Run_FINAL) {
   const auto map = Day18::Map{Day18::readChunks("18/input.txt"), 71U};
   EXPECT_EQ(Day18::escape(map, 1024), 344);
@@ -0,0 +1,141 @@
+#ifndef UTILS_AHO_CORASICK_HH
+#define UTILS_AHO_CORASICK_HH
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "coordinate.hh"
+#include "coordinate_directions.hh"
+
+namespace Utils {
+
+// Automaton that finds any number of (non-empty) patterns in one pass over
+// the text. Transitions are a dense table over just the characters that
+// appear in the patterns; every other character maps to symbol 0, which no
+// pattern continues with.
+class AhoCorasick {
+  static constexpr auto none = std::numeric_limits<uint32_t>::max();
+
+  std::array<uint32_t, 256> symbol_of_{};
+  size_t symbols_{1};
+  std::vector<uint32_t> next_;      // symbols_ per state
+  std::vector<uint32_t> fail_;      // Longest proper suffix that is a state
+  std::vector<uint32_t> order_;     // States, shortest first
+  std::vector<uint32_t> terminal_;  // State per pattern
+
+  [[nodiscard]] static constexpr auto charIndex(char chr) -> size_t {
+    return static_cast<unsigned char>(chr);
+  }
+
+  auto addState() -> uint32_t {
+    next_.resize(next_.size() + symbols_, none);
+    fail_.push_back(0);
+    return static_cast<uint32_t>(fail_.size() - 1);
+  }
+
+ public:
+  explicit AhoCorasick(std::span<const std::string_view> patterns) {
+    for (const auto pattern : patterns) {
+      for (const auto chr : pattern) {
+        auto& symbol = symbol_of_[charIndex(chr)];
+        if (symbol == 0) symbol = static_cast<uint32_t>(symbols_++);
+      }
+    }
+
+    addState();
+    for (const auto pattern : patterns) {
+      auto state = uint32_t{};
+      for (const auto chr : pattern) {
+        const auto edge = state * symbols_ + symbol_of_[charIndex(chr)];
+        if (next_[edge] == none) {
+          const auto added = addState();
+          next_[edge]      = added;
+        }
+        state = next_[edge];
+      }
+      terminal_.push_back(state);
+    }
+
+    // Breadth first, so every failure link already has all its transitions
+    order_.push_back(0);
+    for (size_t idx = 0; idx != order_.size(); ++idx) {
+      const auto state = order_[idx];
+      for (size_t symbol = 0; symbol != symbols_; ++symbol) {
+        auto& target = next_[state * symbols_ + symbol];
+        const auto up =
+            state == 0 ? 0 : next_[fail_[state] * symbols_ + symbol];
+        if (target == none) {
+          target = up;
+        } else {
+          fail_[target] = up;
+          order_.push_back(target);
+        }
+      }
+    }
+  }
+
+  [[nodiscard]] static constexpr auto start() -> uint32_t { return 0; }
+
+  [[nodiscard]] auto states() const -> size_t { return fail_.size(); }
+
+  [[nodiscard]] auto step(uint32_t state, char chr) const -> uint32_t {
+    return next_[state * symbols_ + symbol_of_[charIndex(chr)]];
+  }
+
+  // Occurrences per pattern, given how often every state was entered. Each
+  // state's visits also end every pattern along its failure links, so they
+  // are pushed down the links longest state first.
+  [[nodiscard]] auto patternCounts(std::vector<size_t> visits) const
+      -> std::vector<size_t> {
+    for (auto state = order_.rbegin(); state != order_.rend(); ++state)
+      if (*state != 0) visits[fail_[*state]] += visits[*state];
+
+    auto counts = std::vector<size_t>{};
+    counts.reserve(terminal_.size());
+    for (const auto state : terminal_) counts.push_back(visits[state]);
+    return counts;
+  }
+};
+
+// Occurrences per pattern along every row, column and diagonal of the grid,
+// read both ways. Each line is streamed through the automaton once, so the
+// cost doesn't depend on the number of patterns.
+[[nodiscard]] auto scanGrid(const AhoCorasick& automaton, const auto& grid)
+    -> std::vector<size_t> {
+  const auto width  = static_cast<int>(grid.width());
+  const auto height = static_cast<int>(grid.height());
+
+  auto border = std::vector<Coordinate>{};
+  for (auto x = 0; x != width; ++x) {
+    border.push_back({.x = x, .y = 0});
+    if (height > 1) border.push_back({.x = x, .y = height - 1});
+  }
+  for (auto y = 1; y < height - 1; ++y) {
+    border.push_back({.x = 0, .y = y});
+    if (width > 1) border.push_back({.x = width - 1, .y = y});
+  }
+
+  auto visits = std::vector<size_t>(automaton.states());
+  for (const auto direction : Directions::clockwise()) {
+    for (const auto from : border) {
+      if (grid.inBounds(from - direction)) continue;
+
+      auto state = AhoCorasick::start();
+      for (auto at = from; grid.inBounds(at); at += direction) {
+        state = automaton.step(state, grid[at]);
+        ++visits[state];
+      }
+    }
+  }
+
+  return automaton.patternCounts(std::move(visits));
+}
+
+}  // namespace Utils
+
+#endif  // UTILS_AHO_CORASICK_HH
@@ -52,6 +52,14 @@ struct Directions {
             Direction::left()};
   }
 
+  // Position of an orthogonal direction in orthagonal(); clockwise, so
+  // rotating clockwise is +1 and counter-clockwise is +3 (mod 4).
+  [[nodiscard]] static constexpr auto orthagonalIndex(Coordinate direction)
+      -> size_t {
+    return static_cast<size_t>(direction.x != 0 ? 2 - direction.x
+                                                : 1 + direction.y);
+  }
+
   [[nodiscard]] static constexpr auto diagonal() -> std::array<Coordinate, 4> {
     return {Direction::upRight(), Direction::downRight(), Direction::downLeft(),
             Direction::upLeft()};
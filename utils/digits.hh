@@ -0,0 +1,63 @@
+#ifndef UTILS_DIGITS_HH
+#define UTILS_DIGITS_HH
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <utility>
+
+namespace Utils {
+
+// Most decimal digits a uint64_t can have. 10^max_digits itself doesn't fit.
+inline constexpr auto max_digits = uint8_t{20};
+
+namespace Detail {
+
+inline constexpr auto pow10_table = [] {
+  auto table = std::array<uint64_t, max_digits>{};
+  auto power = uint64_t{1};
+  for (auto& entry : table) {
+    entry = power;
+    power *= 10U;
+  }
+  return table;
+}();
+
+}  // namespace Detail
+
+// 10^exponent, for exponent < max_digits
+[[nodiscard]] constexpr auto pow10(size_t exponent) -> uint64_t {
+  return Detail::pow10_table[exponent];
+}
+
+// Decimal digits in `number`, zero counting as one. 1233 / 4096 is just under
+// log10(2), so the bit width gives the digit count or one less; a single table
+// lookup settles which.
+[[nodiscard]] constexpr auto countDigits(std::unsigned_integral auto number)
+    -> uint8_t {
+  const auto value = static_cast<uint64_t>(number) | 1U;
+  const auto guess =
+      (static_cast<uint32_t>(std::bit_width(value)) * 1233U) >> 12U;
+  return static_cast<uint8_t>(guess + (value >= pow10(guess) ? 1U : 0U));
+}
+
+// The digits of `a` followed by the digits of `b`, wrapping like any other
+// uint64_t arithmetic when that doesn't fit
+[[nodiscard]] constexpr auto concat(uint64_t a, uint64_t b) -> uint64_t {
+  const auto digits = countDigits(b);
+  if (digits == max_digits) return a * pow10(max_digits - 1U) * 10U + b;
+  return a * pow10(digits) + b;
+}
+
+// Left and right half of the digits of `number`, which should have an even
+// number of them. Leading zeroes of the right half are dropped.
+[[nodiscard]] constexpr auto splitHalves(uint64_t number)
+    -> std::pair<uint64_t, uint64_t> {
+  const auto divisor = pow10(countDigits(number) / 2U);
+  return {number / divisor, number % divisor};
+}
+
+}  // namespace Utils
+
+#endif  // UTILS_DIGITS_HH
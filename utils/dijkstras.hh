@@ -1,10 +1,15 @@
 #ifndef UTILS_DIJKSTRAS_HH
 #define UTILS_DIJKSTRAS_HH
 
+#include <algorithm>
+#include <cstdint>
 #include <limits>
+#include <optional>
 #include <queue>
+#include <span>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace Utils::Detail {
 
@@ -34,44 +39,122 @@ struct WeightedEdge {
 };
 
 template <typename DISTANCE, typename EDGE>
-[[nodiscard]] auto dijkstra(WeightedEdge<DISTANCE, EDGE> start,
-                            auto&& adjacent) {
-  auto distances = Detail::default_map<EDGE, DISTANCE>{};
-  auto previous  = std::unordered_map<EDGE, std::unordered_set<EDGE>>{};
+struct TaggedEdge {
+  DISTANCE distance;
+  EDGE edge;
+  uint8_t tag;  // Move kind, [0..7); doubles as the predecessor bit
+};
+
+// Multi-target searches stop as soon as the first target is settled, once
+// every target as near as the first one is settled, or once every target is
+// settled. The first target settled is always the nearest one.
+enum class Settle : uint8_t { AnyTarget, NearestTargets, AllTargets };
+
+template <typename DISTANCE, typename EDGE>
+struct ShortestPaths {
+  static constexpr auto on_path = uint8_t{0x80};
+
+  std::vector<DISTANCE> distances;
+  std::vector<uint8_t> previous;  // Per state bitmask of TaggedEdge::tag
+  std::vector<uint32_t> settled;  // States in order of increasing distance
+  std::optional<WeightedEdge<DISTANCE, EDGE>> nearest;  // Closest target
+};
+
+// All shortest paths over a dense state space. `index` maps an EDGE onto
+// [0, states), `adjacent` yields TaggedEdges. Every state remembers which
+// kinds of moves reached it at its shortest distance, so the caller can undo
+// a (state, tag) pair to walk the shortest path DAG backwards. A state's
+// predecessors are complete once it is settled, so stopping early at the
+// targets still leaves their part of the DAG intact.
+template <typename DISTANCE, typename EDGE>
+[[nodiscard]] auto dijkstra(
+    std::span<const WeightedEdge<DISTANCE, EDGE>> starts,
+    std::span<const EDGE> targets, Settle settle, size_t states, auto&& index,
+    auto&& adjacent) -> ShortestPaths<DISTANCE, EDGE> {
+  auto paths = ShortestPaths<DISTANCE, EDGE>{
+      .distances = std::vector<DISTANCE>(states,
+                                         std::numeric_limits<DISTANCE>::max()),
+      .previous  = std::vector<uint8_t>(states),
+      .settled   = {},
+      .nearest   = std::nullopt};
+
+  auto is_target = std::vector<bool>(states);
+  for (const auto& target : targets) is_target[index(target)] = true;
+  auto remaining = std::ranges::count(is_target, true);
 
   auto queue = std::priority_queue<WeightedEdge<DISTANCE, EDGE>>{};
-  queue.push(start);
+  for (const auto& start : starts) {
+    auto& shortest = paths.distances[index(start.edge)];
+    if (start.distance < shortest) {
+      shortest = start.distance;
+      queue.push(start);
+    }
+  }
 
   while (!queue.empty()) {
     const auto [distance, current] = queue.top();
     queue.pop();
 
-    for (const auto [distance_to, other] : adjacent(current)) {
-      if (distance + distance_to < distances.at_or_max(other)) {
-        distances[other] = distance + distance_to;
-        queue.push({distances[other], other});
+    const auto at = index(current);
+    if (distance != paths.distances[at]) continue;
+    if (settle == Settle::NearestTargets and paths.nearest and
+        paths.nearest->distance < distance)
+      break;
+    paths.settled.push_back(static_cast<uint32_t>(at));
+
+    if (is_target[at]) {
+      if (!paths.nearest) paths.nearest = {distance, current};
+      if (settle == Settle::AnyTarget or --remaining == 0) break;
+    }
+
+    for (const auto [distance_to, other, tag] : adjacent(current)) {
+      const auto to  = index(other);
+      auto& shortest = paths.distances[to];
+      if (distance + distance_to < shortest) {
+        shortest           = distance + distance_to;
+        paths.previous[to] = 0;
+        queue.push({shortest, other});
       }
-      if (distance + distance_to <= distances.at_or_max(other))
-        previous[other].insert(current);
+      if (distance + distance_to == shortest)
+        paths.previous[to] |= static_cast<uint8_t>(1U << tag);
     }
   }
 
-  return std::make_pair(distances, previous);
+  return paths;
 }
 
+// Targets reached from any of several starts, in order of increasing
+// distance, over a sparse state space.
 template <typename DISTANCE, typename EDGE>
-[[nodiscard]] auto dijkstra(WeightedEdge<DISTANCE, EDGE> start, EDGE finish,
-                            auto&& adjacent) {
+[[nodiscard]] auto dijkstra(
+    std::span<const WeightedEdge<DISTANCE, EDGE>> starts,
+    std::span<const EDGE> targets, Settle settle,
+    auto&& adjacent) -> std::vector<WeightedEdge<DISTANCE, EDGE>> {
   auto distances = Detail::default_map<EDGE, DISTANCE>{};
+  auto remaining = std::unordered_set<EDGE>(targets.begin(), targets.end());
+  auto arrivals  = std::vector<WeightedEdge<DISTANCE, EDGE>>{};
 
   auto queue = std::priority_queue<WeightedEdge<DISTANCE, EDGE>>{};
-  queue.push(start);
+  for (const auto& start : starts) {
+    if (start.distance < distances.at_or_max(start.edge)) {
+      distances[start.edge] = start.distance;
+      queue.push(start);
+    }
+  }
 
-  while (!queue.empty()) {
+  while (!queue.empty() and !remaining.empty()) {
     const auto [distance, current] = queue.top();
     queue.pop();
 
-    if (current == finish) return distance;
+    if (distance != distances.at_or_max(current)) continue;
+    if (settle == Settle::NearestTargets and !arrivals.empty() and
+        arrivals.front().distance < distance)
+      break;
+
+    if (remaining.erase(current) != 0) {
+      arrivals.push_back({distance, current});
+      if (settle == Settle::AnyTarget) break;
+    }
 
     for (const auto [distance_to, other] : adjacent(current)) {
       if (distance + distance_to < distances.at_or_max(other)) {
@@ -81,7 +164,27 @@ template <typename DISTANCE, typename EDGE>
     }
   }
 
-  return DISTANCE{};
+  return arrivals;
+}
+
+// Nearest of several targets from any of several starts.
+template <typename DISTANCE, typename EDGE>
+[[nodiscard]] auto dijkstra(
+    std::span<const WeightedEdge<DISTANCE, EDGE>> starts,
+    std::span<const EDGE> targets,
+    auto&& adjacent) -> std::optional<WeightedEdge<DISTANCE, EDGE>> {
+  const auto arrivals =
+      dijkstra<DISTANCE, EDGE>(starts, targets, Settle::AnyTarget, adjacent);
+  if (arrivals.empty()) return std::nullopt;
+  return arrivals.front();
+}
+
+template <typename DISTANCE, typename EDGE>
+[[nodiscard]] auto dijkstra(WeightedEdge<DISTANCE, EDGE> start, EDGE finish,
+                            auto&& adjacent) -> DISTANCE {
+  const auto arrival = dijkstra<DISTANCE, EDGE>(
+      std::span{&start, 1}, std::span{&finish, 1}, adjacent);
+  return arrival ? arrival->distance : DISTANCE{};
 }
 
 }  // namespace Utils
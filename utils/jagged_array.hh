@@ -0,0 +1,79 @@
+#ifndef UTILS_JAGGED_ARRAY_HH
+#define UTILS_JAGGED_ARRAY_HH
+
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <vector>
+
+namespace Utils {
+
+// Rows of varying length, stored back to back in one buffer (CSR style), plus
+// where every row starts. Rows are handed out as spans into that buffer.
+template <typename T>
+class JaggedArray {
+  std::vector<T> values_{};
+  std::vector<size_t> offsets_{0};
+
+ public:
+  class Iterator {
+    const JaggedArray* array_{};
+    size_t row_{};
+
+   public:
+    using value_type      = std::span<const T>;
+    using difference_type = std::ptrdiff_t;
+
+    Iterator() = default;
+    Iterator(const JaggedArray* array, size_t row) : array_{array}, row_{row} {}
+
+    [[nodiscard]] auto operator*() const -> value_type {
+      return (*array_)[row_];
+    }
+
+    auto operator++() -> Iterator& {
+      ++row_;
+      return *this;
+    }
+
+    auto operator++(int) -> Iterator {
+      auto before = *this;
+      ++row_;
+      return before;
+    }
+
+    [[nodiscard]] auto operator==(const Iterator& other) const -> bool {
+      return row_ == other.row_;
+    }
+  };
+
+  // Appends a value to the row that the next endRow() closes
+  void push_back(const T& value) { values_.push_back(value); }
+
+  void endRow() { offsets_.push_back(values_.size()); }
+
+  [[nodiscard]] auto size() const -> size_t { return offsets_.size() - 1; }
+
+  [[nodiscard]] auto empty() const -> bool { return size() == 0; }
+
+  [[nodiscard]] auto operator[](size_t row) const -> std::span<const T> {
+    return std::span{values_}.subspan(offsets_[row],
+                                      offsets_[row + 1] - offsets_[row]);
+  }
+
+  [[nodiscard]] auto operator[](size_t row) -> std::span<T> {
+    return std::span{values_}.subspan(offsets_[row],
+                                      offsets_[row + 1] - offsets_[row]);
+  }
+
+  // Every value of every row, in order
+  [[nodiscard]] auto values() const -> std::span<const T> { return values_; }
+
+  [[nodiscard]] auto begin() const -> Iterator { return {this, 0}; }
+
+  [[nodiscard]] auto end() const -> Iterator { return {this, size()}; }
+};
+
+}  // namespace Utils
+
+#endif  // UTILS_JAGGED_ARRAY_HH
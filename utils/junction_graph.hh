@@ -0,0 +1,117 @@
+#ifndef UTILS_JUNCTION_GRAPH_HH
+#define UTILS_JUNCTION_GRAPH_HH
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <ranges>
+#include <span>
+#include <vector>
+
+#include "coordinate.hh"
+#include "coordinate_directions.hh"
+#include "grid.hh"
+
+namespace Utils {
+
+// A grid maze with its corridors contracted. Every open cell that doesn't have
+// exactly two open neighbors (or that the caller wants to keep) becomes a
+// junction; the corridors between junctions become weighted edges that remember
+// the cells they cover.
+template <typename DISTANCE>
+struct JunctionGraph {
+  static constexpr auto none = std::numeric_limits<uint32_t>::max();
+
+  struct Corridor {
+    uint32_t to{none};
+    Coordinate arriving{};  // Direction of the last step into `to`
+    DISTANCE distance{};
+    uint32_t cells_begin{};
+    uint32_t cells_end{};
+  };
+
+  std::vector<Coordinate> junctions;
+  std::vector<Corridor> corridors;  // Four per junction, see orthagonalIndex()
+  std::vector<Coordinate> cells;    // Cells in between junctions, per corridor
+  Grid<uint32_t> junction_at;       // Junction index per cell, or `none`
+
+  [[nodiscard]] constexpr auto corridor(size_t junction,
+                                        Coordinate direction) const
+      -> const Corridor& {
+    return corridors[junction * 4 + Directions::orthagonalIndex(direction)];
+  }
+
+  [[nodiscard]] constexpr auto cellsOf(const Corridor& corridor) const
+      -> std::span<const Coordinate> {
+    return std::span{cells}.subspan(corridor.cells_begin,
+                                    corridor.cells_end - corridor.cells_begin);
+  }
+};
+
+template <typename DISTANCE, typename OOB_POLICY>
+[[nodiscard]] auto contractMaze(const Grid<char, OOB_POLICY>& maze, char wall,
+                                DISTANCE step_cost, DISTANCE turn_cost,
+                                auto&& keep) -> JunctionGraph<DISTANCE> {
+  using Graph = JunctionGraph<DISTANCE>;
+
+  const auto is_open = [&](Coordinate at) {
+    return maze.inBounds(at) and maze[at] != wall;
+  };
+
+  const auto exits = [&](Coordinate at) {
+    return std::ranges::count_if(Directions::orthagonal(), [&](auto direction) {
+      return is_open(at + direction);
+    });
+  };
+
+  auto graph = Graph{
+      .junctions   = {},
+      .corridors   = {},
+      .cells       = {},
+      .junction_at = Grid<uint32_t>{maze.width(), maze.height()}};
+
+  for (const auto at : maze.coordinates()) {
+    graph.junction_at[at] = Graph::none;
+    if (is_open(at) and (exits(at) != 2 or keep(at))) {
+      graph.junction_at[at] = static_cast<uint32_t>(graph.junctions.size());
+      graph.junctions.push_back(at);
+    }
+  }
+
+  graph.corridors.resize(graph.junctions.size() * 4);
+  for (size_t junction = 0; junction != graph.junctions.size(); ++junction) {
+    const auto from = graph.junctions[junction];
+    for (const auto leaving : Directions::orthagonal()) {
+      if (!is_open(from + leaving)) continue;
+
+      auto& corridor =
+          graph.corridors[junction * 4 + Directions::orthagonalIndex(leaving)];
+      corridor.cells_begin = static_cast<uint32_t>(graph.cells.size());
+      corridor.distance    = step_cost;
+
+      auto at        = from + leaving;
+      auto direction = leaving;
+      while (graph.junction_at[at] == Graph::none) {
+        graph.cells.push_back(at);
+        if (!is_open(at + direction)) {
+          direction = is_open(at + rotatedClockwise(direction))
+                          ? rotatedClockwise(direction)
+                          : rotatedCounterClockwise(direction);
+          corridor.distance += turn_cost;
+        }
+        at += direction;
+        corridor.distance += step_cost;
+      }
+
+      corridor.to        = graph.junction_at[at];
+      corridor.arriving  = direction;
+      corridor.cells_end = static_cast<uint32_t>(graph.cells.size());
+    }
+  }
+
+  return graph;
+}
+
+}  // namespace Utils
+
+#endif  // UTILS_JUNCTION_GRAPH_HH
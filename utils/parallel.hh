@@ -0,0 +1,55 @@
+#ifndef UTILS_PARALLEL_HH
+#define UTILS_PARALLEL_HH
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace Utils {
+
+[[nodiscard]] inline auto hardwareThreads() -> size_t {
+  return std::max(1U, std::thread::hardware_concurrency());
+}
+
+// Sums work(idx) over [0, count) on up to `workers` threads. Every thread
+// gets its own `work` from make_work(), so it can keep scratch state between
+// items. Indices are handed out one at a time, which keeps the threads busy
+// even when some items cost far more than others.
+template <typename RESULT>
+[[nodiscard]] auto parallelSum(size_t count, auto&& make_work,
+                               size_t workers = hardwareThreads()) -> RESULT {
+  auto next  = std::atomic<size_t>{};
+  auto total = std::atomic<RESULT>{};
+
+  {
+    auto threads = std::vector<std::jthread>{};
+    for (size_t worker = 0; worker != std::min(workers, count); ++worker) {
+      threads.emplace_back([&] {
+        auto work = make_work();
+        auto sum  = RESULT{};
+        for (auto idx = next++; idx < count; idx = next++) sum += work(idx);
+        total += sum;
+      });
+    }
+  }
+
+  return total;
+}
+
+// Calls work(idx) for every idx in [0, count) on up to `workers` threads
+void parallelFor(size_t count, auto&& work,
+                 size_t workers = hardwareThreads()) {
+  auto next = std::atomic<size_t>{};
+
+  auto threads = std::vector<std::jthread>{};
+  for (size_t worker = 0; worker != std::min(workers, count); ++worker) {
+    threads.emplace_back([&] {
+      for (auto idx = next++; idx < count; idx = next++) work(idx);
+    });
+  }
+}
+
+}  // namespace Utils
+
+#endif  // UTILS_PARALLEL_HH
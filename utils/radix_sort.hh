@@ -0,0 +1,46 @@
+#ifndef UTILS_RADIX_SORT_HH
+#define UTILS_RADIX_SORT_HH
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace Utils {
+
+// LSD radix sort for 32 bit keys: four stable counting passes over a byte
+// each, ping-ponging between `values` and one scratch buffer. A pass where
+// every key has the same byte is skipped. Signed keys get their sign bit
+// flipped, so negative numbers sort first.
+template <typename T>
+  requires(std::integral<T> and sizeof(T) == 4)
+void radixSort(std::span<T> values) {
+  static constexpr auto flip = std::is_signed_v<T> ? 0x8000'0000U : 0U;
+  const auto digit           = [](T value, unsigned shift) -> size_t {
+    return ((static_cast<uint32_t>(value) ^ flip) >> shift) & 0xFFU;
+  };
+
+  auto scratch = std::vector<T>(values.size());
+  auto from    = values;
+  auto to      = std::span{scratch};
+
+  for (auto shift = 0U; shift != 32U; shift += 8U) {
+    auto starts = std::array<size_t, 257>{};
+    for (const auto value : from) ++starts[digit(value, shift) + 1];
+    if (std::ranges::find(starts, from.size()) != starts.end()) continue;
+
+    for (size_t idx = 1; idx != starts.size(); ++idx)
+      starts[idx] += starts[idx - 1];
+    for (const auto value : from) to[starts[digit(value, shift)]++] = value;
+    std::swap(from, to);
+  }
+
+  if (from.data() != values.data()) std::ranges::copy(from, values.begin());
+}
+
+}  // namespace Utils
+
+#endif  // UTILS_RADIX_SORT_HH
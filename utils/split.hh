@@ -3,9 +3,13 @@
 
 #include <array>
 #include <charconv>
+#include <span>
+#include <string>
 #include <string_view>
 #include <vector>
 
+#include "jagged_array.hh"
+
 namespace Utils {
 
 template <typename T, size_t SIZE>
@@ -27,10 +31,10 @@ template <typename T, size_t SIZE>
   return values;
 }
 
+// Calls fn(value) for every value in between delimiters, without collecting
+// them anywhere
 template <typename T>
-[[nodiscard]] auto split(std::string_view str,
-                         std::string_view delimiter) -> std::vector<T> {
-  auto values = std::vector<T>{};
+void splitEach(std::string_view str, std::string_view delimiter, auto&& fn) {
   while (!str.empty()) {
     const auto delimiter_at = str.find(delimiter);
     auto value              = T{};
@@ -41,11 +45,30 @@ template <typename T>
       std::from_chars(str.begin(), str.end(), value);
       str = {};
     }
-    values.emplace_back(value);
+    fn(value);
   }
+}
+
+template <typename T>
+[[nodiscard]] auto split(std::string_view str,
+                         std::string_view delimiter) -> std::vector<T> {
+  auto values = std::vector<T>{};
+  splitEach<T>(str, delimiter, [&](T value) { values.emplace_back(value); });
   return values;
 }
 
+// One row per line, parsed straight into a single buffer
+template <typename T>
+[[nodiscard]] auto splitLines(std::span<const std::string> lines,
+                              std::string_view delimiter) -> JaggedArray<T> {
+  auto rows = JaggedArray<T>{};
+  for (const auto& line : lines) {
+    splitEach<T>(line, delimiter, [&](T value) { rows.push_back(value); });
+    rows.endRow();
+  }
+  return rows;
+}
+
 }  // namespace Utils
 
 #endif  // SPLIT_HH